@@ -0,0 +1,78 @@
+// File: KnxAddress.cpp
+// Parsing of group (1/2/3) and individual (1.2.3) addresses without String.
+
+#include "KnxAddress.h"
+
+/**
+ * Parse three decimal parts separated by aDelimiter in a single pass.
+ * @param aMax the maximum value of each part.
+ * @param aShift the bit position of the first and the second part.
+ */
+static KnxAddressParseResultType parseAddress(const char* aText, char aDelimiter, const uint8_t aMax[3],
+                                              const uint8_t aShift[2], uint16_t* aAddress)
+{
+    if (aText == NULL || *aText == 0)
+    {
+        return KNX_ADDRESS_EMPTY;
+    }
+
+    uint16_t part[3] = { 0, 0, 0 };
+    uint8_t index = 0;
+    bool digits = false;
+    for (const char* c = aText; ; c++)
+    {
+        if (*c >= '0' && *c <= '9')
+        {
+            // checked per digit, so the part never exceeds 10 * 255 + 9
+            part[index] = part[index] * 10 + (*c - '0');
+            if (part[index] > aMax[index])
+            {
+                return KNX_ADDRESS_OUT_OF_RANGE;
+            }
+            digits = true;
+        }
+        else if (*c == aDelimiter || *c == 0)
+        {
+            if (!digits)
+            {
+                return KNX_ADDRESS_MISSING_PART;
+            }
+            if (*c == 0)
+            {
+                break;
+            }
+            if (index == 2)
+            {
+                return KNX_ADDRESS_TOO_MANY_PARTS;
+            }
+            index++;
+            digits = false;
+        }
+        else
+        {
+            return KNX_ADDRESS_INVALID_CHARACTER;
+        }
+    }
+
+    if (index < 2)
+    {
+        return KNX_ADDRESS_MISSING_PART;
+    }
+    // shifted as unsigned, a signed 16 bit int (AVR) would overflow for main groups above 15
+    *aAddress = (uint16_t)(((unsigned int)part[0] << aShift[0]) | ((unsigned int)part[1] << aShift[1]) | part[2]);
+    return KNX_ADDRESS_OK;
+}
+
+KnxAddressParseResultType KnxAddress::parseGroupAddress(const char* aText, uint16_t* aAddress)
+{
+    static const uint8_t max[3]   = { 31, 7, 255 };
+    static const uint8_t shift[2] = { 11, 8 };
+    return parseAddress(aText, '/', max, shift, aAddress);
+}
+
+KnxAddressParseResultType KnxAddress::parseIndividualAddress(const char* aText, uint16_t* aAddress)
+{
+    static const uint8_t max[3]   = { 15, 15, 255 };
+    static const uint8_t shift[2] = { 12, 8 };
+    return parseAddress(aText, '.', max, shift, aAddress);
+}
@@ -0,0 +1,128 @@
+// File: KnxAddress.h
+// Parsing of group (1/2/3) and individual (1.2.3) addresses without String.
+
+#ifndef KnxAddress_h
+#define KnxAddress_h
+
+#include "Arduino.h"
+#include "KnxTelegram.h"
+
+/**
+ * Result of parsing an address.
+ */
+enum KnxAddressParseResultType
+{
+  KNX_ADDRESS_OK,
+  KNX_ADDRESS_EMPTY,              // NULL or empty text
+  KNX_ADDRESS_INVALID_CHARACTER,  // anything else than digits and the delimiter
+  KNX_ADDRESS_MISSING_PART,       // less than three parts or an empty part
+  KNX_ADDRESS_TOO_MANY_PARTS,     // more than three parts
+  KNX_ADDRESS_OUT_OF_RANGE        // a part exceeds its bits, e.g. main group 32
+};
+
+/**
+ * Converts addresses in text form into the two byte address.
+ * The parsers read the text once and allocate nothing. Each part is a decimal number,
+ * leading zeros are allowed, white space is not.
+ */
+class KnxAddress
+{
+  public:
+    /**
+     * Parse a three level group address main/middle/sub (0-31/0-7/0-255).
+     * @param aText the text to parse, e.g. "1/2/3".
+     * @param aAddress receives the address, it is only changed if the text is valid.
+     * @return KNX_ADDRESS_OK or the reason why the text is not a group address.
+     */
+    static KnxAddressParseResultType parseGroupAddress(const char* aText, uint16_t* aAddress);
+
+    /**
+     * Parse an individual address area.line.member (0-15.0-15.0-255).
+     * @param aText the text to parse, e.g. "1.1.20".
+     * @param aAddress receives the address, it is only changed if the text is valid.
+     * @return KNX_ADDRESS_OK or the reason why the text is not an individual address.
+     */
+    static KnxAddressParseResultType parseIndividualAddress(const char* aText, uint16_t* aAddress);
+
+    /**
+     * Compile time variant of #parseGroupAddress(), e.g.
+     * <pre>
+     * constexpr uint16_t light = KnxAddress::group("1/2/3");
+     * </pre>
+     * An invalid literal fails to compile in a constant expression, at run time it gives 0.
+     */
+    static constexpr uint16_t group(const char* aText)
+    {
+        return parse(aText, '/', 31, 7, 11, 8);
+    }
+
+    /**
+     * Compile time variant of #parseIndividualAddress(), see #group().
+     */
+    static constexpr uint16_t individual(const char* aText)
+    {
+        return parse(aText, '.', 15, 15, 12, 8);
+    }
+
+  private:
+    static constexpr bool isDigit(char aChar)
+    {
+        return aChar >= '0' && aChar <= '9';
+    }
+
+    /**
+     * @return the first character behind the digits at aText.
+     */
+    static constexpr const char* skipNumber(const char* aText)
+    {
+        return isDigit(*aText) ? skipNumber(aText + 1) : aText;
+    }
+
+    /**
+     * @return the value of the digits at aText, saturated above 0xFFFF to catch overflows.
+     */
+    static constexpr uint32_t number(const char* aText, uint32_t aValue = 0)
+    {
+        return isDigit(*aText) ? number(aText + 1, aValue > 0xFFFF ? aValue : aValue * 10 + (*aText - '0')) : aValue;
+    }
+
+    /**
+     * Not constexpr, so reaching it while evaluating a constant expression is a compile error.
+     */
+    static uint16_t invalidAddress()
+    {
+        return 0;
+    }
+
+    static constexpr uint16_t parse(const char* aText, char aDelimiter, uint8_t aMax1, uint8_t aMax2, uint8_t aShift1, uint8_t aShift2)
+    {
+        return parseSecond(aText, skipNumber(aText), aDelimiter, aMax1, aMax2, aShift1, aShift2);
+    }
+
+    static constexpr uint16_t parseSecond(const char* aFirst, const char* aEnd, char aDelimiter,
+                                          uint8_t aMax1, uint8_t aMax2, uint8_t aShift1, uint8_t aShift2)
+    {
+        return (aEnd != aFirst && *aEnd == aDelimiter)
+            ? parseThird(aFirst, aEnd + 1, skipNumber(aEnd + 1), aDelimiter, aMax1, aMax2, aShift1, aShift2)
+            : invalidAddress();
+    }
+
+    static constexpr uint16_t parseThird(const char* aFirst, const char* aSecond, const char* aEnd, char aDelimiter,
+                                         uint8_t aMax1, uint8_t aMax2, uint8_t aShift1, uint8_t aShift2)
+    {
+        return (aEnd != aSecond && *aEnd == aDelimiter)
+            ? combine(aFirst, aSecond, aEnd + 1, skipNumber(aEnd + 1), aMax1, aMax2, aShift1, aShift2)
+            : invalidAddress();
+    }
+
+    static constexpr uint16_t combine(const char* aFirst, const char* aSecond, const char* aThird, const char* aEnd,
+                                      uint8_t aMax1, uint8_t aMax2, uint8_t aShift1, uint8_t aShift2)
+    {
+        return (aEnd != aThird && *aEnd == 0
+                && number(aFirst) <= aMax1 && number(aSecond) <= aMax2 && number(aThird) <= 255)
+            ? (uint16_t)((number(aFirst) << aShift1) | (number(aSecond) << aShift2) | number(aThird))
+            : invalidAddress();
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+// File: KnxClock.h
+// Time base and wait policy of KnxTpUart, see KnxTpUart::setClock().
+
+#ifndef KnxClock_h
+#define KnxClock_h
+
+#include "Arduino.h"
+
+/**
+ * The clock KnxTpUart takes all its timestamps and timeouts from and the way it waits for bytes.
+ * The default is the Arduino clock and waits without sleeping, so a byte is seen as soon as it
+ * arrives and timeouts are kept to the microsecond instead of the 1 ms steps of delay().
+ * Derived classes put the library on another time base, e.g. the virtual clock of a test or
+ * a simulation, or let it sleep until the next interrupt while it waits.
+ */
+class KnxClock
+{
+  public:
+    /**
+     * @return a monotonic time in microseconds, wrapping around like micros().
+     */
+    virtual unsigned long getMicros()
+    {
+        return micros();
+    }
+
+    /**
+     * @return a monotonic time in milliseconds, wrapping around like millis().
+     */
+    virtual unsigned long getMillis()
+    {
+        return millis();
+    }
+
+    /**
+     * Called while the library waits for a received byte or for a point in time.
+     * It may return any time, the caller checks again, but should not return later than aMaxUs
+     * from now. The default returns at once after giving the system a chance to run.
+     * @param aMaxUs the time in microseconds until the wait ends if no byte arrives.
+     */
+    virtual void wait(unsigned long aMaxUs)
+    {
+        yield();
+    }
+};
+
+#endif
@@ -0,0 +1,397 @@
+// File: KnxDpt.h
+// Encoding and decoding of the KNX datapoint types supported by the library.
+
+#ifndef KnxDpt_h
+#define KnxDpt_h
+
+#include "Arduino.h"
+
+/**
+ * Each datapoint type is a struct with static inline codec functions, used as template argument of
+ * KnxTelegram::set(), KnxTelegram::get(), KnxTelegramTemplate::set() and KnxTpUart::groupWrite() / groupAnswer(), e.g.:
+ * <pre>
+ * knx.groupWrite<KnxDpt9>(KNX_GA(1,2,3), 21.5);
+ * float t = telegram->get<KnxDpt9>();
+ * </pre>
+ * Every codec provides:
+ * - Type: the value type.
+ * - Size: the number of value bytes behind the command, 0 for values stored in the 6 bits of the first data byte.
+ * - encode(aValue, aData): write the value to aData (the first data byte for Size 0, otherwise the value bytes).
+ * - decode(aData): read the value back from the same position.
+ */
+
+/**
+ * DPT-1, 1 bit boolean (switch, enable, ...)
+ */
+struct KnxDpt1
+{
+    typedef bool Type;
+    static const uint8_t Size = 0;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = (aData[0] & B11000000) | (aValue ? 0x01 : 0x00);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return aData[0] & B00000001;
+    }
+};
+
+/**
+ * DPT-3, 4 bit control (direction in bit 3, steps in bit 0-2)
+ */
+struct KnxDpt3
+{
+    typedef uint8_t Type;
+    static const uint8_t Size = 0;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = (aData[0] & B11000000) | (aValue & B00001111);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return aData[0] & B00001111;
+    }
+};
+
+/**
+ * DPT-5, 1 byte unsigned
+ */
+struct KnxDpt5
+{
+    typedef uint8_t Type;
+    static const uint8_t Size = 1;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = aValue;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return aData[0];
+    }
+};
+
+/**
+ * DPT-6, 1 byte signed
+ */
+struct KnxDpt6
+{
+    typedef int8_t Type;
+    static const uint8_t Size = 1;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = (uint8_t)aValue;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return (int8_t)aData[0];
+    }
+};
+
+/**
+ * DPT-7, 2 byte unsigned
+ */
+struct KnxDpt7
+{
+    typedef uint16_t Type;
+    static const uint8_t Size = 2;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = (uint8_t)(aValue >> 8);
+        aData[1] = (uint8_t)aValue;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return (((uint16_t)aData[0]) << 8) | aData[1];
+    }
+};
+
+/**
+ * DPT-8, 2 byte signed
+ */
+struct KnxDpt8
+{
+    typedef int16_t Type;
+    static const uint8_t Size = 2;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        KnxDpt7::encode((uint16_t)aValue, aData);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return (int16_t)KnxDpt7::decode(aData);
+    }
+};
+
+/**
+ * The range of a DPT-9 value in hundredths: -2048 * 2^15 to 2047 * 2^15.
+ */
+#define KNX_DPT9_MIN_HUNDREDTHS (-67108864L)
+#define KNX_DPT9_MAX_HUNDREDTHS (67076096L)
+
+/**
+ * DPT-9, 2 byte float (sign, 4 bit exponent, 11 bit two's complement mantissa in 0.01)
+ * The conversion is done in hundredths with integer shifts only, the float value is converted once.
+ */
+struct KnxDpt9
+{
+    typedef float Type;
+    static const uint8_t Size = 2;
+
+    /**
+     * Encode a value given in hundredths (e.g. 2150 for 21.50), values out of range are clamped.
+     * The mantissa is rounded half away from zero, the exponent is the smallest one that fits.
+     */
+    static inline void encodeHundredths(int32_t aValue, uint8_t* aData)
+    {
+        if (aValue < KNX_DPT9_MIN_HUNDREDTHS) aValue = KNX_DPT9_MIN_HUNDREDTHS;
+        if (aValue > KNX_DPT9_MAX_HUNDREDTHS) aValue = KNX_DPT9_MAX_HUNDREDTHS;
+
+        bool negative = aValue < 0;
+        uint32_t magnitude = negative ? -aValue : aValue;
+        // the positive mantissa ends at 2047, the negative one at -2048
+        uint32_t limit = negative ? 2048 : 2047;
+        uint8_t exponent = 0;
+        while (magnitude > limit)
+        {
+            limit <<= 1;
+            exponent++;
+        }
+        if (exponent > 0)
+        {
+            magnitude = (magnitude + (1UL << (exponent - 1))) >> exponent;
+        }
+
+        // sign in bit 15, exponent in bit 11-14, two's complement mantissa in bit 0-10
+        uint16_t raw = ((uint16_t)exponent << 11) | (magnitude & 0x7FF);
+        if (negative && magnitude != 0)
+        {
+            raw = ((uint16_t)exponent << 11) | ((2048 - magnitude) & 0x7FF) | 0x8000;
+        }
+        aData[0] = (uint8_t)(raw >> 8);
+        aData[1] = (uint8_t)raw;
+    }
+
+    /**
+     * @return the value in hundredths, exact for all encodings.
+     */
+    static inline int32_t decodeHundredths(const uint8_t* aData)
+    {
+        int32_t mantissa = ((aData[0] & B00000111) << 8) | aData[1];
+        if (aData[0] & B10000000)
+        {
+            mantissa -= 2048;
+        }
+        return mantissa * (1L << ((aData[0] & B01111000) >> 3));
+    }
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        float hundredths = aValue * 100.0f;
+        if (hundredths < KNX_DPT9_MIN_HUNDREDTHS) hundredths = KNX_DPT9_MIN_HUNDREDTHS;
+        if (hundredths > KNX_DPT9_MAX_HUNDREDTHS) hundredths = KNX_DPT9_MAX_HUNDREDTHS;
+        encodeHundredths(lround(hundredths), aData);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return decodeHundredths(aData) / 100.0f;
+    }
+};
+
+/**
+ * DPT-9 with the value in hundredths (int32_t, e.g. 2150 for 21.50), no floating point is used at all.
+ */
+struct KnxDpt9Hundredths
+{
+    typedef int32_t Type;
+    static const uint8_t Size = 2;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        KnxDpt9::encodeHundredths(aValue, aData);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return KnxDpt9::decodeHundredths(aData);
+    }
+};
+
+/**
+ * The value of a DPT-10 time.
+ */
+struct KnxTime
+{
+    uint8_t weekday; // 1-7, 0 for no day
+    uint8_t hour;    // 0-23
+    uint8_t minute;  // 0-59
+    uint8_t second;  // 0-59
+};
+
+/**
+ * DPT-10, 3 byte time of day
+ */
+struct KnxDpt10
+{
+    typedef KnxTime Type;
+    static const uint8_t Size = 3;
+
+    static inline void encode(const Type& aValue, uint8_t* aData)
+    {
+        // bit 5-7 for weekday, bit 0-4 for hour
+        aData[0] = ((aValue.weekday << 5) & B11100000) | (aValue.hour & B00011111);
+        aData[1] = aValue.minute & B00111111;
+        aData[2] = aValue.second & B00111111;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        Type value;
+        value.weekday = (aData[0] & B11100000) >> 5;
+        value.hour    = aData[0] & B00011111;
+        value.minute  = aData[1] & B00111111;
+        value.second  = aData[2] & B00111111;
+        return value;
+    }
+};
+
+/**
+ * The value of a DPT-11 date.
+ */
+struct KnxDate
+{
+    uint8_t day;   // 1-31
+    uint8_t month; // 1-12
+    uint8_t year;  // 0-99
+};
+
+/**
+ * DPT-11, 3 byte date
+ */
+struct KnxDpt11
+{
+    typedef KnxDate Type;
+    static const uint8_t Size = 3;
+
+    static inline void encode(const Type& aValue, uint8_t* aData)
+    {
+        aData[0] = aValue.day & B00011111;
+        aData[1] = aValue.month & B00001111;
+        aData[2] = aValue.year;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        Type value;
+        value.day   = aData[0] & B00011111;
+        value.month = aData[1] & B00001111;
+        value.year  = aData[2];
+        return value;
+    }
+};
+
+/**
+ * DPT-12, 4 byte unsigned
+ */
+struct KnxDpt12
+{
+    typedef uint32_t Type;
+    static const uint8_t Size = 4;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        aData[0] = (uint8_t)(aValue >> 24);
+        aData[1] = (uint8_t)(aValue >> 16);
+        aData[2] = (uint8_t)(aValue >> 8);
+        aData[3] = (uint8_t)aValue;
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        uint32_t value = aData[0];
+        value = (value << 8) | aData[1];
+        value = (value << 8) | aData[2];
+        value = (value << 8) | aData[3];
+        return value;
+    }
+};
+
+/**
+ * DPT-13, 4 byte signed
+ */
+struct KnxDpt13
+{
+    typedef int32_t Type;
+    static const uint8_t Size = 4;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        KnxDpt12::encode((uint32_t)aValue, aData);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        return (int32_t)KnxDpt12::decode(aData);
+    }
+};
+
+/**
+ * DPT-14, 4 byte IEEE 754 float
+ */
+struct KnxDpt14
+{
+    typedef float Type;
+    static const uint8_t Size = 4;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        uint32_t bits;
+        memcpy(&bits, &aValue, sizeof(bits));
+        KnxDpt12::encode(bits, aData);
+    }
+
+    static inline Type decode(const uint8_t* aData)
+    {
+        uint32_t bits = KnxDpt12::decode(aData);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * DPT-16, 14 byte text, shorter text is padded with 0. Encode only, use KnxTelegram::get14ByteValue() to read.
+ */
+struct KnxDpt16
+{
+    typedef const char* Type;
+    static const uint8_t Size = 14;
+
+    static inline void encode(Type aValue, uint8_t* aData)
+    {
+        uint8_t i = 0;
+        for (; i < Size && aValue[i] != 0; i++)
+        {
+            aData[i] = aValue[i];
+        }
+        for (; i < Size; i++)
+        {
+            aData[i] = 0;
+        }
+    }
+};
+
+#endif
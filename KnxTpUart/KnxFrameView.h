@@ -0,0 +1,237 @@
+// File: KnxFrameView.h
+// Read only access to a telegram in place, e.g. inside a receive buffer or a captured log.
+
+#ifndef KnxFrameView_h
+#define KnxFrameView_h
+
+#include "Arduino.h"
+#include "KnxTelegram.h"
+
+/**
+ * A view of a telegram stored somewhere else as raw bytes (header, payload, checksum).
+ * Nothing is copied, all accessors decode the bytes in place and are inline, the header
+ * accessors are constexpr so a view over constant data is evaluated by the compiler.
+ * The bytes have to stay valid and unchanged as long as the view is used.
+ * <pre>
+ * KnxFrameView frame(bytes, length);
+ * if (frame.isValid() && frame.isTargetGroup() && frame.getTargetGroupAddress() == KNX_GA(1,2,3))
+ * {
+ *     float t = frame.get<KnxDpt9>();
+ * }
+ * </pre>
+ */
+class KnxFrameView
+{
+  public:
+    /**
+     * @param aFrame the first byte of the telegram (the control field).
+     * @param aLength the number of bytes available at aFrame, used by #isValid() and #get().
+     */
+    constexpr KnxFrameView(const uint8_t* aFrame, uint8_t aLength = MAX_KNX_TELEGRAM_SIZE)
+        : mFrame(aFrame), mLength(aLength)
+    {
+    }
+
+    /**
+     * @return the raw bytes.
+     */
+    constexpr const uint8_t* getBuffer() const
+    {
+        return mFrame;
+    }
+
+    /**
+     * @return the number of bytes available, which may be more than the telegram.
+     */
+    constexpr uint8_t getLength() const
+    {
+        return mLength;
+    }
+
+    /**
+     * @return the byte at the given offset of the telegram.
+     */
+    constexpr uint8_t getBufferByte(uint8_t aIndex) const
+    {
+        return mFrame[aIndex];
+    }
+
+    /**
+     * @return true if the telegram repeat flag is set (the flag bit is cleared on the bus).
+     */
+    constexpr bool isRepeated() const
+    {
+        return (mFrame[0] & B00100000) == 0;
+    }
+
+    constexpr KnxPriorityType getPriority() const
+    {
+        return (KnxPriorityType)((mFrame[0] & B00001100) >> 2);
+    }
+
+    constexpr uint16_t getSourceAddress() const
+    {
+        return (((uint16_t)mFrame[1]) << 8) | mFrame[2];
+    }
+
+    constexpr uint8_t getSourceArea() const
+    {
+        return mFrame[1] >> 4;
+    }
+
+    constexpr uint8_t getSourceLine() const
+    {
+        return mFrame[1] & B00001111;
+    }
+
+    constexpr uint8_t getSourceMember() const
+    {
+        return mFrame[2];
+    }
+
+    constexpr bool isTargetGroup() const
+    {
+        return (mFrame[5] & B10000000) != 0;
+    }
+
+    /**
+     * @return the target address, group or individual address depending on #isTargetGroup().
+     */
+    constexpr uint16_t getTargetAddress() const
+    {
+        return (((uint16_t)mFrame[3]) << 8) | mFrame[4];
+    }
+
+    /**
+     * @return the target group address, this does not check if the target is a group address.
+     */
+    constexpr uint16_t getTargetGroupAddress() const
+    {
+        return getTargetAddress();
+    }
+
+    constexpr uint8_t getTargetMainGroup() const
+    {
+        return (mFrame[3] & B11111000) >> 3;
+    }
+
+    constexpr uint8_t getTargetMiddleGroup() const
+    {
+        return mFrame[3] & B00000111;
+    }
+
+    constexpr uint8_t getTargetSubGroup() const
+    {
+        return mFrame[4];
+    }
+
+    constexpr uint8_t getTargetArea() const
+    {
+        return (mFrame[3] & B11110000) >> 4;
+    }
+
+    constexpr uint8_t getTargetLine() const
+    {
+        return mFrame[3] & B00001111;
+    }
+
+    constexpr uint8_t getTargetMember() const
+    {
+        return mFrame[4];
+    }
+
+    constexpr uint8_t getRoutingCounter() const
+    {
+        return (mFrame[5] & B01110000) >> 4;
+    }
+
+    /**
+     * @return the payload length including the two command bytes.
+     */
+    constexpr uint8_t getPayloadLength() const
+    {
+        return (mFrame[5] & B00001111) + 1;
+    }
+
+    /**
+     * @return the telegram length including header and checksum.
+     */
+    constexpr uint8_t getTotalLength() const
+    {
+        return KNX_TELEGRAM_HEADER_SIZE + getPayloadLength() + 1;
+    }
+
+    constexpr KnxCommunicationType getCommunicationType() const
+    {
+        return (KnxCommunicationType)((mFrame[6] & B11000000) >> 6);
+    }
+
+    constexpr uint8_t getSequenceNumber() const
+    {
+        return (mFrame[6] & B00111100) >> 2;
+    }
+
+    constexpr KnxControlDataType getControlData() const
+    {
+        return (KnxControlDataType)(mFrame[6] & B00000011);
+    }
+
+    constexpr KnxCommandType getCommand() const
+    {
+        return (KnxCommandType)(((mFrame[6] & B00000011) << 2) | ((mFrame[7] & B11000000) >> 6));
+    }
+
+    constexpr uint8_t getFirstDataByte() const
+    {
+        return mFrame[7] & B00111111;
+    }
+
+    constexpr uint8_t getChecksum() const
+    {
+        return mFrame[getTotalLength() - 1];
+    }
+
+    /**
+     * @return true if the checksum matches the telegram.
+     */
+    inline bool verifyChecksum() const
+    {
+        uint8_t checksum = 0xFF;
+        uint8_t last = getTotalLength() - 1;
+        for (uint8_t i = 0; i < last; i++)
+        {
+            checksum ^= mFrame[i];
+        }
+        return checksum == mFrame[last];
+    }
+
+    /**
+     * @return true if the available bytes hold the complete telegram and its checksum matches.
+     */
+    inline bool isValid() const
+    {
+        return mLength > KNX_TELEGRAM_HEADER_SIZE && getTotalLength() <= mLength && verifyChecksum();
+    }
+
+    /**
+     * Decode the value as the given datapoint type, see KnxDpt.h.
+     * @return the value or a zero value if the payload length does not match the type
+     *         or the telegram is not completely available.
+     */
+    template<typename Dpt>
+    typename Dpt::Type get() const
+    {
+        if (getPayloadLength() != Dpt::Size + 2 || getTotalLength() > mLength)
+        {
+            return typename Dpt::Type();
+        }
+        return Dpt::decode(mFrame + (Dpt::Size == 0 ? 7 : 8));
+    }
+
+  private:
+    const uint8_t* mFrame;
+
+    uint8_t mLength;
+};
+
+#endif
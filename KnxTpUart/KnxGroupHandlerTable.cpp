@@ -0,0 +1,109 @@
+// File: KnxGroupHandlerTable.cpp
+// Binding of application handlers to group addresses.
+
+#include "KnxGroupHandlerTable.h"
+
+KnxGroupHandlerTable::KnxGroupHandlerTable()
+{
+    mEntries = NULL;
+    mCount   = 0;
+    mMax     = 0;
+}
+
+uint16_t KnxGroupHandlerTable::upperBound(uint16_t aAddress)
+{
+    uint16_t lo = 0;
+    uint16_t hi = mCount;
+    while (lo < hi)
+    {
+        uint16_t mid = lo + ((hi - lo) >> 1);
+        if (mEntries[mid].first <= aAddress)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool KnxGroupHandlerTable::add(uint16_t aFirst, uint16_t aLast, KnxGroupHandlerType aHandler, void *aContext)
+{
+    if (aLast < aFirst || aHandler == NULL)
+    {
+        return false;
+    }
+
+    uint16_t pos = upperBound(aFirst);
+    if (pos > 0 && mEntries[pos - 1].first == aFirst && mEntries[pos - 1].last == aLast)
+    {
+        // same range, replace the handler
+        mEntries[pos - 1].handler = aHandler;
+        mEntries[pos - 1].context = aContext;
+        return true;
+    }
+    if ((pos > 0 && mEntries[pos - 1].last >= aFirst) || (pos < mCount && mEntries[pos].first <= aLast))
+    {
+        // overlapping ranges are not supported
+        return false;
+    }
+
+    if (mCount >= mMax)
+    {
+        uint16_t count = (mMax < 4) ? 4 : mMax + (mMax >> 1);
+        if (count <= mMax)
+        {
+            return false;
+        }
+        KnxGroupHandlerEntry *entries = (KnxGroupHandlerEntry *)realloc(mEntries, (size_t)count * sizeof(KnxGroupHandlerEntry));
+        if (entries == NULL)
+        {
+            return false;
+        }
+        mEntries = entries;
+        mMax     = count;
+    }
+
+    memmove(mEntries + pos + 1, mEntries + pos, (mCount - pos) * sizeof(KnxGroupHandlerEntry));
+    mEntries[pos].first   = aFirst;
+    mEntries[pos].last    = aLast;
+    mEntries[pos].handler = aHandler;
+    mEntries[pos].context = aContext;
+    mCount++;
+    return true;
+}
+
+bool KnxGroupHandlerTable::remove(uint16_t aAddress)
+{
+    uint16_t pos = upperBound(aAddress);
+    if (pos == 0 || mEntries[pos - 1].last < aAddress)
+    {
+        return false;
+    }
+
+    memmove(mEntries + pos - 1, mEntries + pos, (mCount - pos) * sizeof(KnxGroupHandlerEntry));
+    mCount--;
+    return true;
+}
+
+void KnxGroupHandlerTable::clear()
+{
+    mCount = 0;
+}
+
+const KnxGroupHandlerEntry *KnxGroupHandlerTable::find(uint16_t aAddress)
+{
+    uint16_t pos = upperBound(aAddress);
+    if (pos > 0 && mEntries[pos - 1].last >= aAddress)
+    {
+        return &mEntries[pos - 1];
+    }
+    return NULL;
+}
+
+uint16_t KnxGroupHandlerTable::getCount()
+{
+    return mCount;
+}
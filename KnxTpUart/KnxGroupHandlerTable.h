@@ -0,0 +1,87 @@
+// File: KnxGroupHandlerTable.h
+// Binding of application handlers to group addresses.
+
+#ifndef KnxGroupHandlerTable_h
+#define KnxGroupHandlerTable_h
+
+#include "Arduino.h"
+#include "KnxTelegram.h"
+
+/**
+ * Definition of the handler type a received group telegram is dispatched to.
+ * @param aTelegram the received telegram, valid until the next call of KnxTpUart::serialEvent().
+ * @param aContext the context pointer given when the handler was added.
+ */
+typedef void (*KnxGroupHandlerType)(KnxTelegram *aTelegram, void *aContext);
+
+/**
+ * A handler bound to a range of group addresses, both ends included.
+ */
+struct KnxGroupHandlerEntry
+{
+    uint16_t first;
+    uint16_t last;
+    KnxGroupHandlerType handler;
+    void *context;
+};
+
+/**
+ * Sorted array of non overlapping group address ranges with their handler.
+ * A lookup is a binary search over the ranges, a single GA is a range of length one.
+ */
+class KnxGroupHandlerTable
+{
+  public:
+    KnxGroupHandlerTable();
+
+    /**
+     * Bind a handler to the group addresses from aFirst to aLast (both included).
+     * Adding the same range again replaces its handler. The table grows on demand.
+     * @param aFirst the first group address.
+     * @param aLast the last group address.
+     * @param aHandler the handler to call.
+     * @param aContext a pointer passed to the handler unchanged.
+     * @return true if the handler was added, false if the range overlaps another one or no memory was left.
+     */
+    bool add(uint16_t aFirst, uint16_t aLast, KnxGroupHandlerType aHandler, void *aContext);
+
+    /**
+     * Remove the range containing the given group address.
+     * @return true if a range was removed, false if none contains the address.
+     */
+    bool remove(uint16_t aAddress);
+
+    /**
+     * Remove all handlers, the memory is kept for reuse.
+     */
+    void clear();
+
+    /**
+     * @param aAddress the group address to look for.
+     * @return the entry whose range contains the address or NULL if there is none.
+     *         The pointer is only valid until the table is modified.
+     */
+    const KnxGroupHandlerEntry *find(uint16_t aAddress);
+
+    /**
+     * @return the number of ranges added.
+     */
+    uint16_t getCount();
+
+  private:
+    /**
+     * @return the index of the first entry starting above aAddress.
+     */
+    uint16_t upperBound(uint16_t aAddress);
+
+    /**
+     * The entries in ascending order of their ranges.
+     */
+    KnxGroupHandlerEntry *mEntries;
+
+    uint16_t mCount;
+
+    uint16_t mMax;
+};
+
+#endif
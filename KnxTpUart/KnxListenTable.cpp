@@ -0,0 +1,556 @@
+// File: KnxListenTable.cpp
+// Storage for the group addresses a KnxTpUart listens to.
+
+#include "KnxListenTable.h"
+
+KnxListenTableLinear::KnxListenTableLinear()
+{
+    mAddresses = NULL;
+    mCount     = 0;
+    mMax       = 0;
+}
+
+bool KnxListenTableLinear::setCapacity(uint16_t aCount)
+{
+    if (aCount <= mMax)
+    {
+        return true;
+    }
+
+    // grow the buffer (2 bytes per address), the added addresses are kept
+    uint16_t *addresses = (uint16_t *)realloc(mAddresses, (size_t)aCount * sizeof(uint16_t));
+    if (addresses == NULL)
+    {
+        // not possible to allocate buffer, the old one is still valid
+        return false;
+    }
+
+    mAddresses = addresses;
+    mMax       = aCount;
+    return true;
+}
+
+bool KnxListenTableLinear::reserveOne()
+{
+    if (mCount < mMax)
+    {
+        return true;
+    }
+    if (mMax == 0xFFFF)
+    {
+        return false;
+    }
+
+    uint32_t count = (mMax < 4) ? 4 : (uint32_t)mMax + (mMax >> 1);
+    return setCapacity(count > 0xFFFF ? 0xFFFF : (uint16_t)count);
+}
+
+bool KnxListenTableLinear::add(uint16_t aAddress)
+{
+    if (!reserveOne())
+    {
+        return false;
+    }
+    mAddresses[mCount] = aAddress;
+    mCount++;
+    return true;
+}
+
+bool KnxListenTableLinear::contains(uint16_t aAddress)
+{
+    for (uint16_t i = 0; i < mCount; i++)
+    {
+        if (mAddresses[i] == aAddress)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void KnxListenTableLinear::clear()
+{
+    mCount = 0;
+}
+
+uint16_t KnxListenTableLinear::getCount()
+{
+    return mCount;
+}
+
+size_t KnxListenTableLinear::getMemoryUsage()
+{
+    return (size_t)mMax * sizeof(uint16_t);
+}
+
+
+uint16_t KnxListenTableSorted::lowerBound(uint16_t aAddress)
+{
+    uint16_t lo = 0;
+    uint16_t hi = mCount;
+    while (lo < hi)
+    {
+        uint16_t mid = lo + ((hi - lo) >> 1);
+        if (mAddresses[mid] < aAddress)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool KnxListenTableSorted::add(uint16_t aAddress)
+{
+    uint16_t pos = lowerBound(aAddress);
+    if (pos < mCount && mAddresses[pos] == aAddress)
+    {
+        // already listening
+        return true;
+    }
+    if (!reserveOne())
+    {
+        return false;
+    }
+
+    memmove(mAddresses + pos + 1, mAddresses + pos, (mCount - pos) * sizeof(uint16_t));
+    mAddresses[pos] = aAddress;
+    mCount++;
+    return true;
+}
+
+bool KnxListenTableSorted::contains(uint16_t aAddress)
+{
+    uint16_t pos = lowerBound(aAddress);
+    return (pos < mCount && mAddresses[pos] == aAddress);
+}
+
+
+KnxListenTableRanges::KnxListenTableRanges()
+{
+    mRuns     = NULL;
+    mRunCount = 0;
+    mRunMax   = 0;
+    mCount    = 0;
+}
+
+bool KnxListenTableRanges::setCapacity(uint16_t aCount)
+{
+    if (aCount <= mRunMax)
+    {
+        return true;
+    }
+
+    KnxListenRange *runs = (KnxListenRange *)realloc(mRuns, (size_t)aCount * sizeof(KnxListenRange));
+    if (runs == NULL)
+    {
+        return false;
+    }
+
+    mRuns   = runs;
+    mRunMax = aCount;
+    return true;
+}
+
+uint16_t KnxListenTableRanges::upperBound(uint16_t aAddress)
+{
+    uint16_t lo = 0;
+    uint16_t hi = mRunCount;
+    while (lo < hi)
+    {
+        uint16_t mid = lo + ((hi - lo) >> 1);
+        if (mRuns[mid].first <= aAddress)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool KnxListenTableRanges::add(uint16_t aAddress)
+{
+    uint16_t pos = upperBound(aAddress);
+    if (pos > 0 && mRuns[pos - 1].last >= aAddress)
+    {
+        // already listening
+        return true;
+    }
+
+    // mRuns[pos - 1] ends below aAddress, mRuns[pos] starts above it
+    bool joinPrev = (pos > 0 && mRuns[pos - 1].last + 1 == aAddress);
+    bool joinNext = (pos < mRunCount && mRuns[pos].first - 1 == aAddress);
+
+    if (joinPrev && joinNext)
+    {
+        // aAddress closes the gap between two runs
+        mRuns[pos - 1].last = mRuns[pos].last;
+        memmove(mRuns + pos, mRuns + pos + 1, (mRunCount - pos - 1) * sizeof(KnxListenRange));
+        mRunCount--;
+    }
+    else if (joinPrev)
+    {
+        mRuns[pos - 1].last = aAddress;
+    }
+    else if (joinNext)
+    {
+        mRuns[pos].first = aAddress;
+    }
+    else
+    {
+        if (mRunCount >= mRunMax)
+        {
+            uint32_t count = (mRunMax < 4) ? 4 : (uint32_t)mRunMax + (mRunMax >> 1);
+            if (!setCapacity(count > 0xFFFF ? 0xFFFF : (uint16_t)count) || mRunCount >= mRunMax)
+            {
+                return false;
+            }
+        }
+        memmove(mRuns + pos + 1, mRuns + pos, (mRunCount - pos) * sizeof(KnxListenRange));
+        mRuns[pos].first = aAddress;
+        mRuns[pos].last  = aAddress;
+        mRunCount++;
+    }
+
+    // all 65536 addresses do not fit into the count, it stops at 0xFFFF
+    if (mCount < 0xFFFF)
+    {
+        mCount++;
+    }
+    return true;
+}
+
+bool KnxListenTableRanges::addRange(uint16_t aFirst, uint16_t aLast)
+{
+    for (uint32_t ga = aFirst; ga <= aLast; ga++)
+    {
+        if (!add((uint16_t)ga))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KnxListenTableRanges::contains(uint16_t aAddress)
+{
+    uint16_t pos = upperBound(aAddress);
+    return (pos > 0 && mRuns[pos - 1].last >= aAddress);
+}
+
+void KnxListenTableRanges::clear()
+{
+    mRunCount = 0;
+    mCount    = 0;
+}
+
+uint16_t KnxListenTableRanges::getCount()
+{
+    return mCount;
+}
+
+uint16_t KnxListenTableRanges::getRunCount()
+{
+    return mRunCount;
+}
+
+size_t KnxListenTableRanges::getMemoryUsage()
+{
+    return (size_t)mRunMax * sizeof(KnxListenRange);
+}
+
+
+KnxListenTableHash::KnxListenTableHash()
+{
+    mBuckets     = NULL;
+    mMask        = 0;
+    mBits        = 0;
+    mHasEmptyKey = false;
+    mCount       = 0;
+    mMax         = 0;
+}
+
+bool KnxListenTableHash::setCapacity(uint16_t aCount)
+{
+    if (aCount <= mMax)
+    {
+        return true;
+    }
+    if (aCount > 0x8000)
+    {
+        return false;
+    }
+
+    // keep the load factor at or below 50% to keep probe sequences short
+    uint8_t bits = 1;
+    while ((1UL << bits) < 2UL * aCount)
+    {
+        bits++;
+    }
+
+    uint32_t size = 1UL << bits;
+    uint16_t *buckets = (uint16_t *)malloc(size * sizeof(uint16_t));
+    if (buckets == NULL)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        buckets[i] = EMPTY;
+    }
+
+    // rehash the added addresses into the new buckets
+    uint16_t *old    = mBuckets;
+    uint32_t oldSize = (old != NULL) ? (uint32_t)mMask + 1 : 0;
+    mBuckets = buckets;
+    mBits    = bits;
+    mMask    = (uint16_t)(size - 1);
+    mMax     = (uint16_t)(size >> 1);
+    for (uint32_t i = 0; i < oldSize; i++)
+    {
+        if (old[i] != EMPTY)
+        {
+            insert(old[i]);
+        }
+    }
+    free(old);
+    return true;
+}
+
+uint16_t KnxListenTableHash::bucket(uint16_t aAddress)
+{
+    // Fibonacci hashing, the sub groups of one middle group spread over the whole table
+    return (uint16_t)(aAddress * 40503U) >> (16 - mBits);
+}
+
+void KnxListenTableHash::insert(uint16_t aAddress)
+{
+    uint16_t i = bucket(aAddress);
+    while (mBuckets[i] != EMPTY)
+    {
+        i = (i + 1) & mMask;
+    }
+    mBuckets[i] = aAddress;
+}
+
+bool KnxListenTableHash::add(uint16_t aAddress)
+{
+    if (contains(aAddress))
+    {
+        return true;
+    }
+    if (mCount >= mMax && (mMax >= 0x8000 || !setCapacity(mMax < 4 ? 4 : 2 * mMax)))
+    {
+        return false;
+    }
+
+    if (aAddress == EMPTY)
+    {
+        mHasEmptyKey = true;
+    }
+    else
+    {
+        insert(aAddress);
+    }
+    mCount++;
+    return true;
+}
+
+bool KnxListenTableHash::contains(uint16_t aAddress)
+{
+    if (aAddress == EMPTY)
+    {
+        return mHasEmptyKey;
+    }
+    if (mBuckets == NULL)
+    {
+        return false;
+    }
+
+    uint16_t i = bucket(aAddress);
+    while (mBuckets[i] != EMPTY)
+    {
+        if (mBuckets[i] == aAddress)
+        {
+            return true;
+        }
+        i = (i + 1) & mMask;
+    }
+    return false;
+}
+
+void KnxListenTableHash::clear()
+{
+    if (mBuckets != NULL)
+    {
+        for (uint32_t i = 0; i <= mMask; i++)
+        {
+            mBuckets[i] = EMPTY;
+        }
+    }
+    mHasEmptyKey = false;
+    mCount       = 0;
+}
+
+uint16_t KnxListenTableHash::getCount()
+{
+    return mCount;
+}
+
+size_t KnxListenTableHash::getMemoryUsage()
+{
+    return (mBuckets != NULL) ? ((size_t)mMask + 1) * sizeof(uint16_t) : 0;
+}
+
+
+KnxListenTableBitmap::KnxListenTableBitmap()
+{
+    mBits  = NULL;
+    mCount = 0;
+}
+
+bool KnxListenTableBitmap::setCapacity(uint16_t aCount)
+{
+    if (mBits == NULL)
+    {
+        mBits = (uint8_t *)malloc(8192);
+        if (mBits == NULL)
+        {
+            return false;
+        }
+        memset(mBits, 0, 8192);
+        mCount = 0;
+    }
+    return true;
+}
+
+bool KnxListenTableBitmap::add(uint16_t aAddress)
+{
+    if (mBits == NULL && !setCapacity(0))
+    {
+        return false;
+    }
+
+    uint8_t mask = 1 << (aAddress & 7);
+    if (!(mBits[aAddress >> 3] & mask))
+    {
+        mBits[aAddress >> 3] |= mask;
+        if (mCount < 0xFFFF)
+        {
+            mCount++;
+        }
+    }
+    return true;
+}
+
+bool KnxListenTableBitmap::contains(uint16_t aAddress)
+{
+    return mBits != NULL && (mBits[aAddress >> 3] & (1 << (aAddress & 7)));
+}
+
+void KnxListenTableBitmap::clear()
+{
+    if (mBits != NULL)
+    {
+        memset(mBits, 0, 8192);
+    }
+    mCount = 0;
+}
+
+uint16_t KnxListenTableBitmap::getCount()
+{
+    return mCount;
+}
+
+size_t KnxListenTableBitmap::getMemoryUsage()
+{
+    return (mBits != NULL) ? 8192 : 0;
+}
+
+
+KnxListenTablePaged::KnxListenTablePaged()
+{
+    memset(mPages, 0, sizeof(mPages));
+    mCount = 0;
+}
+
+bool KnxListenTablePaged::setCapacity(uint16_t aCount)
+{
+    return true;
+}
+
+bool KnxListenTablePaged::add(uint16_t aAddress)
+{
+    uint8_t* page = mPages[aAddress >> 8];
+    if (page == NULL)
+    {
+        page = (uint8_t *)malloc(PAGE_SIZE);
+        if (page == NULL)
+        {
+            return false;
+        }
+        memset(page, 0, PAGE_SIZE);
+        mPages[aAddress >> 8] = page;
+    }
+
+    uint8_t sub  = aAddress & 0xFF;
+    uint8_t mask = 1 << (sub & 7);
+    if (!(page[sub >> 3] & mask))
+    {
+        page[sub >> 3] |= mask;
+        if (mCount < 0xFFFF)
+        {
+            mCount++;
+        }
+    }
+    return true;
+}
+
+bool KnxListenTablePaged::contains(uint16_t aAddress)
+{
+    const uint8_t* page = mPages[aAddress >> 8];
+    uint8_t sub = aAddress & 0xFF;
+    return page != NULL && (page[sub >> 3] & (1 << (sub & 7)));
+}
+
+void KnxListenTablePaged::clear()
+{
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        if (mPages[i] != NULL)
+        {
+            free(mPages[i]);
+            mPages[i] = NULL;
+        }
+    }
+    mCount = 0;
+}
+
+uint16_t KnxListenTablePaged::getCount()
+{
+    return mCount;
+}
+
+uint16_t KnxListenTablePaged::getPageCount()
+{
+    uint16_t res = 0;
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        if (mPages[i] != NULL)
+        {
+            res++;
+        }
+    }
+    return res;
+}
+
+size_t KnxListenTablePaged::getMemoryUsage()
+{
+    return sizeof(mPages) + (size_t)getPageCount() * PAGE_SIZE;
+}
@@ -0,0 +1,351 @@
+// File: KnxListenTable.h
+// Storage for the group addresses a KnxTpUart listens to.
+
+#ifndef KnxListenTable_h
+#define KnxListenTable_h
+
+#include "Arduino.h"
+
+/**
+ * Unsorted array of group addresses with linear search.
+ * This is the smallest implementation, a lookup costs one compare per registered address.
+ */
+class KnxListenTableLinear
+{
+  public:
+    KnxListenTableLinear();
+
+    /**
+     * Reserve memory for the given number of addresses.
+     * Previously added addresses are kept, the table never shrinks.
+     * This method will reserve 2 byte RAM for each address.
+     * @param aCount the number of addresses to reserve memory for.
+     * @return true if the memory could be allocated, false otherwise.
+     */
+    bool setCapacity(uint16_t aCount);
+
+    /**
+     * Add an address to the table. The table grows if it is full.
+     * @param aAddress the group address to add.
+     * @return true if the address was added, false if no memory was left.
+     */
+    bool add(uint16_t aAddress);
+
+    /**
+     * @param aAddress the group address to look for.
+     * @return true if the address was added before, false otherwise.
+     */
+    bool contains(uint16_t aAddress);
+
+    /**
+     * Remove all addresses, the memory is kept for reuse.
+     */
+    void clear();
+
+    /**
+     * @return the number of addresses added.
+     */
+    uint16_t getCount();
+
+    /**
+     * @return the number of bytes allocated on the heap.
+     */
+    size_t getMemoryUsage();
+
+  protected:
+    /**
+     * Make room for one more address, growing the buffer by half if it is full.
+     * @return true if there is room, false if no memory was left.
+     */
+    bool reserveOne();
+
+    /**
+     * The list of group addresses.
+     */
+    uint16_t *mAddresses;
+
+    /**
+     * The number of registered group addresses.
+     */
+    uint16_t mCount;
+
+    /**
+     * The number of addresses that fit into mAddresses.
+     */
+    uint16_t mMax;
+};
+
+/**
+ * Array of group addresses kept in ascending order with binary search.
+ * Same RAM as KnxListenTableLinear, a lookup costs about log2(n) compares.
+ */
+class KnxListenTableSorted : public KnxListenTableLinear
+{
+  public:
+    /**
+     * Insert an address at its sorted position. Adding an address twice is accepted but stores it once.
+     * @param aAddress the group address to add.
+     * @return true if the address was added, false if no memory was left.
+     */
+    bool add(uint16_t aAddress);
+
+    bool contains(uint16_t aAddress);
+
+  protected:
+    /**
+     * @return the index of the first entry not less than aAddress.
+     */
+    uint16_t lowerBound(uint16_t aAddress);
+};
+
+/**
+ * A run of consecutive group addresses, both ends included.
+ */
+struct KnxListenRange
+{
+    uint16_t first;
+    uint16_t last;
+};
+
+/**
+ * Sorted array of runs of consecutive group addresses with binary search.
+ * Devices usually use blocks of consecutive sub groups, each block costs 4 byte RAM
+ * independent of its length. Scattered addresses cost 4 byte each.
+ */
+class KnxListenTableRanges
+{
+  public:
+    KnxListenTableRanges();
+
+    /**
+     * Reserve memory for the given number of runs (at most one per address).
+     * Previously added addresses are kept, the table never shrinks.
+     * @param aCount the number of runs to reserve memory for.
+     * @return true if the memory could be allocated, false otherwise.
+     */
+    bool setCapacity(uint16_t aCount);
+
+    /**
+     * Add an address, it extends or joins adjacent runs where possible.
+     * Adding an address twice is accepted but stores it once.
+     * @return true if the address was added, false if no memory was left.
+     */
+    bool add(uint16_t aAddress);
+
+    /**
+     * Add all addresses from aFirst to aLast (both included).
+     * @return true if the addresses were added, false if no memory was left.
+     */
+    bool addRange(uint16_t aFirst, uint16_t aLast);
+
+    bool contains(uint16_t aAddress);
+
+    void clear();
+
+    /**
+     * @return the number of addresses added, 0xFFFF if all 65536 were added.
+     */
+    uint16_t getCount();
+
+    /**
+     * @return the number of runs stored.
+     */
+    uint16_t getRunCount();
+
+    size_t getMemoryUsage();
+
+  private:
+    /**
+     * @return the index of the first run starting above aAddress.
+     */
+    uint16_t upperBound(uint16_t aAddress);
+
+    /**
+     * The runs in ascending order, neither overlapping nor adjacent.
+     */
+    KnxListenRange *mRuns;
+
+    uint16_t mRunCount;
+
+    uint16_t mRunMax;
+
+    /**
+     * The number of addresses in all runs.
+     */
+    uint16_t mCount;
+};
+
+/**
+ * Open addressing hash table (linear probing) of group addresses.
+ * The table is sized to a power of two of at least twice the capacity, so it needs 4 or more byte RAM
+ * per address, a lookup costs about one compare independent of the number of addresses.
+ */
+class KnxListenTableHash
+{
+  public:
+    KnxListenTableHash();
+
+    /**
+     * Reserve memory for the given number of addresses (at most 32768).
+     * Previously added addresses are kept (rehashed into the larger table).
+     * @param aCount the number of addresses to reserve memory for.
+     * @return true if the memory could be allocated, false otherwise.
+     */
+    bool setCapacity(uint16_t aCount);
+
+    /**
+     * Add an address, the table doubles its size if it is full.
+     * @return true if the address was added, false if no memory was left.
+     */
+    bool add(uint16_t aAddress);
+
+    bool contains(uint16_t aAddress);
+
+    void clear();
+
+    uint16_t getCount();
+
+    size_t getMemoryUsage();
+
+  private:
+    /**
+     * Marker of an unused bucket. The address 0xFFFF itself is tracked by mHasEmptyKey.
+     */
+    static const uint16_t EMPTY = 0xFFFF;
+
+    /**
+     * @return the first bucket to probe for the given address.
+     */
+    uint16_t bucket(uint16_t aAddress);
+
+    /**
+     * Store an address known not to be in the table into a free bucket.
+     */
+    void insert(uint16_t aAddress);
+
+    /**
+     * The buckets, mMask + 1 entries.
+     */
+    uint16_t *mBuckets;
+
+    /**
+     * Number of buckets - 1 (number of buckets is a power of two).
+     */
+    uint16_t mMask;
+
+    /**
+     * Number of bits of the bucket index.
+     */
+    uint8_t mBits;
+
+    /**
+     * True if the address 0xFFFF was added.
+     */
+    bool mHasEmptyKey;
+
+    uint16_t mCount;
+
+    uint16_t mMax;
+};
+
+/**
+ * One bit per possible group address (65536 bit = 8 KiB RAM).
+ * A lookup is a single bit test. Meant for MCUs with plenty of RAM (ESP32) and Linux hosts.
+ */
+class KnxListenTableBitmap
+{
+  public:
+    KnxListenTableBitmap();
+
+    /**
+     * Allocate the bitmap if not yet done.
+     * There is no limit of addresses, so aCount is ignored. Calling this is optional.
+     * @return true if the memory could be allocated, false otherwise.
+     */
+    bool setCapacity(uint16_t aCount);
+
+    /**
+     * Add an address, the bitmap is allocated with the first address.
+     * @return true if the address was added, false if the bitmap could not be allocated.
+     */
+    bool add(uint16_t aAddress);
+
+    bool contains(uint16_t aAddress);
+
+    void clear();
+
+    /**
+     * @return the number of addresses added, 0xFFFF if all 65536 were added.
+     */
+    uint16_t getCount();
+
+    size_t getMemoryUsage();
+
+  private:
+    /**
+     * The bitmap, bit (aAddress & 7) of byte (aAddress >> 3) is set for each added address.
+     */
+    uint8_t *mBits;
+
+    uint16_t mCount;
+};
+
+/**
+ * Two level bitmap: a table of 256 page pointers, one per main/middle group,
+ * and a 256 bit (32 byte) page per main/middle group actually in use.
+ * A lookup is one pointer load and one bit test, RAM grows with the number of used main/middle groups.
+ */
+class KnxListenTablePaged
+{
+  public:
+    KnxListenTablePaged();
+
+    /**
+     * There is no limit of addresses and pages are allocated on demand, so this does nothing.
+     * @return always true.
+     */
+    bool setCapacity(uint16_t aCount);
+
+    /**
+     * Add an address, the page of its main/middle group is allocated on first use.
+     * @return true if the address was added, false if the page could not be allocated.
+     */
+    bool add(uint16_t aAddress);
+
+    bool contains(uint16_t aAddress);
+
+    /**
+     * Remove all addresses and free all pages.
+     */
+    void clear();
+
+    /**
+     * @return the number of addresses added, 0xFFFF if all 65536 were added.
+     */
+    uint16_t getCount();
+
+    /**
+     * @return the number of pages allocated.
+     */
+    uint16_t getPageCount();
+
+    /**
+     * @return the number of bytes used by the page table and the pages.
+     */
+    size_t getMemoryUsage();
+
+  private:
+    /**
+     * Number of bytes per page (one bit per sub group).
+     */
+    static const uint8_t PAGE_SIZE = 32;
+
+    /**
+     * The pages indexed by the high byte of the address (main/middle group), NULL if not in use.
+     */
+    uint8_t *mPages[256];
+
+    uint16_t mCount;
+};
+
+#endif
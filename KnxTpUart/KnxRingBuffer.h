@@ -0,0 +1,147 @@
+// File: KnxRingBuffer.h
+// Single producer / single consumer byte ring used between a UART interrupt and the telegram receiver.
+
+#ifndef KnxRingBuffer_h
+#define KnxRingBuffer_h
+
+#include "Arduino.h"
+
+/**
+ * Load an index written by the other side of the ring.
+ * On AVR a single byte access is atomic anyway, on multi core hosts this orders the buffer access.
+ */
+#define KNX_RING_LOAD(aIndex) __atomic_load_n(&(aIndex), __ATOMIC_ACQUIRE)
+
+/**
+ * Publish an index to the other side of the ring.
+ */
+#define KNX_RING_STORE(aIndex, aValue) __atomic_store_n(&(aIndex), (aValue), __ATOMIC_RELEASE)
+
+/**
+ * A lock free ring buffer for exactly one producer (e.g. UART ISR) and one consumer (the telegram receiver).
+ * The head is only written by the producer, the tail only by the consumer.
+ * Both are free running 8 bit counters, so the capacity must be a power of two of at most 128.
+ */
+template<uint8_t SIZE>
+class KnxRingBuffer
+{
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "KnxRingBuffer size must be a power of two");
+    static_assert(SIZE <= 128, "KnxRingBuffer size must not exceed 128");
+
+  public:
+    KnxRingBuffer()
+    {
+        mHead    = 0;
+        mTail    = 0;
+        mOverrun = 0;
+    }
+
+    /**
+     * Add a byte to the ring. Only to be called by the producer.
+     * @param aByte the byte to add.
+     * @return true if the byte was added, false if the ring is full and the byte was dropped.
+     */
+    bool push(uint8_t aByte)
+    {
+        uint8_t head = mHead;
+        if ((uint8_t)(head - KNX_RING_LOAD(mTail)) >= SIZE)
+        {
+            if (mOverrun < 255)
+            {
+                mOverrun++;
+            }
+            return false;
+        }
+        mBuffer[head & (SIZE - 1)] = aByte;
+        KNX_RING_STORE(mHead, (uint8_t)(head + 1));
+        return true;
+    }
+
+    /**
+     * @return the number of bytes that can be read. Only to be called by the consumer.
+     */
+    uint8_t available()
+    {
+        return KNX_RING_LOAD(mHead) - mTail;
+    }
+
+    /**
+     * @return the next byte without removing it or -1 if the ring is empty.
+     */
+    int peek()
+    {
+        uint8_t tail = mTail;
+        if (KNX_RING_LOAD(mHead) == tail)
+        {
+            return -1;
+        }
+        return mBuffer[tail & (SIZE - 1)];
+    }
+
+    /**
+     * Remove and return the next byte.
+     * @return the byte read or -1 if the ring is empty.
+     */
+    int read()
+    {
+        uint8_t tail = mTail;
+        if (KNX_RING_LOAD(mHead) == tail)
+        {
+            return -1;
+        }
+        uint8_t res = mBuffer[tail & (SIZE - 1)];
+        KNX_RING_STORE(mTail, (uint8_t)(tail + 1));
+        return res;
+    }
+
+    /**
+     * Remove up to aCount bytes in one go. The consumed space is handed back to the producer once at the end.
+     * @param aBuffer the buffer to copy the bytes into.
+     * @param aCount the maximum number of bytes to read.
+     * @return the number of bytes read.
+     */
+    uint8_t read(uint8_t* aBuffer, uint8_t aCount)
+    {
+        uint8_t tail  = mTail;
+        uint8_t avail = KNX_RING_LOAD(mHead) - tail;
+        if (aCount > avail)
+        {
+            aCount = avail;
+        }
+        for (uint8_t i = 0; i < aCount; i++)
+        {
+            aBuffer[i] = mBuffer[(uint8_t)(tail + i) & (SIZE - 1)];
+        }
+        KNX_RING_STORE(mTail, (uint8_t)(tail + aCount));
+        return aCount;
+    }
+
+    /**
+     * @return the number of bytes dropped by #push() because the ring was full, it stops at 255.
+     */
+    uint8_t getOverrunCount()
+    {
+        return mOverrun;
+    }
+
+  private:
+    uint8_t mBuffer[SIZE];
+
+    /**
+     * Free running write counter, only modified by the producer.
+     */
+    volatile uint8_t mHead;
+
+    /**
+     * Free running read counter, only modified by the consumer.
+     */
+    volatile uint8_t mTail;
+
+    /**
+     * Number of dropped bytes, only modified by the producer.
+     * A single byte, so the consumer reads it without disabling interrupts on AVR.
+     */
+    volatile uint8_t mOverrun;
+};
+
+#endif
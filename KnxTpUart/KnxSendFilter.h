@@ -0,0 +1,239 @@
+// File: KnxSendFilter.h
+// Send-on-change filter with deadband and heartbeat for group writes.
+
+#ifndef KnxSendFilter_h
+#define KnxSendFilter_h
+
+#include "Arduino.h"
+#include "KnxTelegram.h"
+
+// Maximum payload stored per filter entry (everything behind the header up to the checksum)
+#define KNX_SEND_FILTER_PAYLOAD_SIZE (MAX_KNX_TELEGRAM_SIZE - KNX_TELEGRAM_HEADER_SIZE - 1)
+
+/**
+ * How a filter entry interprets the value of a telegram for the deadband.
+ */
+enum KnxSendFilterValueType
+{
+  KNX_FILTER_RAW,          // no numeric value, any change of the payload is sent
+  KNX_FILTER_1BYTE_INT,    // DPT-6
+  KNX_FILTER_1BYTE_UINT,   // DPT-5
+  KNX_FILTER_2BYTE_INT,    // DPT-8
+  KNX_FILTER_2BYTE_UINT,   // DPT-7
+  KNX_FILTER_2BYTE_FLOAT,  // DPT-9
+  KNX_FILTER_4BYTE_INT,    // DPT-13
+  KNX_FILTER_4BYTE_UINT,   // DPT-12
+  KNX_FILTER_4BYTE_FLOAT   // DPT-14
+};
+
+/**
+ * The filter settings and the last value sent of one group address.
+ */
+struct KnxSendFilterEntry
+{
+  uint16_t address;
+  KnxSendFilterValueType type;
+  float absolute;            // minimum absolute change to send, 0 for none
+  uint8_t relative;          // minimum change in percent of the last value to send, 0 for none
+  uint16_t maxInterval;      // seconds after which the value is sent even if unchanged, 0 for never
+  bool sent;                 // true if payload, value and time hold the last value sent
+  uint8_t length;
+  uint8_t payload[KNX_SEND_FILTER_PAYLOAD_SIZE];
+  float value;
+  unsigned long time;        // millis when the last value was sent
+};
+
+/**
+ * A fixed size table of send filters, one per group address.
+ * A group write passes the filter if there is no entry for its address, nothing was sent yet,
+ * the value changed by at least one of the deadbands (any change if no deadband is set)
+ * or the heartbeat interval expired. Everything else is suppressed.
+ */
+template<uint8_t SIZE>
+class KnxSendFilter
+{
+  public:
+    KnxSendFilter()
+    {
+        clear();
+    }
+
+    /**
+     * Add a filter for a group address, an existing one for the same address is replaced.
+     * @param aAddress the group address.
+     * @param aType how to read the value for the deadbands.
+     * @param aAbsolute the minimum absolute change of the value to send, 0 for none.
+     * @param aRelative the minimum change in percent of the last value sent, 0 for none.
+     * @param aMaxInterval the time in seconds after which an unchanged value is sent again, 0 for never.
+     * @return true if the filter was added, false if the table is full.
+     */
+    bool add(uint16_t aAddress, KnxSendFilterValueType aType, float aAbsolute, uint8_t aRelative, uint16_t aMaxInterval)
+    {
+        KnxSendFilterEntry* entry = find(aAddress);
+        if (entry == NULL)
+        {
+            if (mCount >= SIZE)
+            {
+                return false;
+            }
+            entry = &mEntries[mCount++];
+        }
+        entry->address     = aAddress;
+        entry->type        = aType;
+        entry->absolute    = aAbsolute;
+        entry->relative    = aRelative;
+        entry->maxInterval = aMaxInterval;
+        entry->sent        = false;
+        return true;
+    }
+
+    /**
+     * Remove the filter of a group address.
+     * @return true if there was one.
+     */
+    bool remove(uint16_t aAddress)
+    {
+        KnxSendFilterEntry* entry = find(aAddress);
+        if (entry == NULL)
+        {
+            return false;
+        }
+        *entry = mEntries[--mCount];
+        return true;
+    }
+
+    /**
+     * Remove all filters.
+     */
+    void clear()
+    {
+        mCount = 0;
+    }
+
+    /**
+     * Decide if a telegram is sent and remember it as last value sent if so.
+     * Only group writes are filtered, reads and answers always pass.
+     * @param aTelegram the telegram to send.
+     * @param aNow the current time (millis).
+     * @return true if the telegram is to be sent, false if it is suppressed.
+     */
+    bool pass(KnxTelegram* aTelegram, unsigned long aNow)
+    {
+        if (mCount == 0 || !aTelegram->isTargetGroup() || aTelegram->getCommand() != KNX_COMMAND_WRITE)
+        {
+            return true;
+        }
+        KnxSendFilterEntry* entry = find(aTelegram->getTargetGroupAddress());
+        if (entry == NULL)
+        {
+            return true;
+        }
+
+        uint8_t length = aTelegram->getPayloadLength();
+        if (length > KNX_SEND_FILTER_PAYLOAD_SIZE)
+        {
+            length = KNX_SEND_FILTER_PAYLOAD_SIZE;
+        }
+        const uint8_t* payload = aTelegram->getBuffer() + KNX_TELEGRAM_HEADER_SIZE;
+        float value = getValue(aTelegram, entry->type);
+
+        if (entry->sent && !changed(entry, payload, length, value)
+            && (entry->maxInterval == 0 || (aNow - entry->time) < entry->maxInterval * 1000UL))
+        {
+            return false;
+        }
+
+        entry->sent   = true;
+        entry->length = length;
+        memcpy(entry->payload, payload, length);
+        entry->value  = value;
+        entry->time   = aNow;
+        return true;
+    }
+
+    /**
+     * Forget the last value sent to a group address, e.g. because sending failed.
+     * The next write to the address passes the filter.
+     */
+    void invalidate(uint16_t aAddress)
+    {
+        KnxSendFilterEntry* entry = find(aAddress);
+        if (entry != NULL)
+        {
+            entry->sent = false;
+        }
+    }
+
+    /**
+     * @return the number of filters added.
+     */
+    uint8_t getCount()
+    {
+        return mCount;
+    }
+
+  private:
+    KnxSendFilterEntry* find(uint16_t aAddress)
+    {
+        for (uint8_t i = 0; i < mCount; i++)
+        {
+            if (mEntries[i].address == aAddress)
+            {
+                return &mEntries[i];
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * @return the value of the telegram as float, 0 for KNX_FILTER_RAW.
+     */
+    static float getValue(KnxTelegram* aTelegram, KnxSendFilterValueType aType)
+    {
+        switch (aType)
+        {
+            case KNX_FILTER_1BYTE_INT:
+                return aTelegram->get1ByteIntValue();
+            case KNX_FILTER_1BYTE_UINT:
+                return aTelegram->get1ByteUIntValue();
+            case KNX_FILTER_2BYTE_INT:
+                return aTelegram->get2ByteIntValue();
+            case KNX_FILTER_2BYTE_UINT:
+                return aTelegram->get2ByteUIntValue();
+            case KNX_FILTER_2BYTE_FLOAT:
+                return aTelegram->get2ByteFloatValue();
+            case KNX_FILTER_4BYTE_INT:
+                return aTelegram->get4ByteIntValue();
+            case KNX_FILTER_4BYTE_UINT:
+                return aTelegram->get4ByteUIntValue();
+            case KNX_FILTER_4BYTE_FLOAT:
+                return aTelegram->get4ByteFloatValue();
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * @return true if the payload differs from the last one sent by more than the deadbands.
+     */
+    static bool changed(KnxSendFilterEntry* aEntry, const uint8_t* aPayload, uint8_t aLength, float aValue)
+    {
+        if (aEntry->type == KNX_FILTER_RAW || (aEntry->absolute <= 0 && aEntry->relative == 0))
+        {
+            return aLength != aEntry->length || memcmp(aPayload, aEntry->payload, aLength) != 0;
+        }
+
+        float delta = fabs(aValue - aEntry->value);
+        if (aEntry->absolute > 0 && delta >= aEntry->absolute)
+        {
+            return true;
+        }
+        return aEntry->relative > 0 && delta > 0 && delta * 100 >= fabs(aEntry->value) * aEntry->relative;
+    }
+
+    KnxSendFilterEntry mEntries[SIZE];
+
+    uint8_t mCount;
+};
+
+#endif
@@ -19,7 +19,7 @@ void KnxTelegram::clear()
 {
 
     // initialize buffer to all 0
-    memset(buffer, 0, sizeof(MAX_KNX_TELEGRAM_SIZE));
+    memset(buffer, 0, sizeof(buffer));
 
     // Initialize control fields
 
@@ -340,313 +340,137 @@ uint8_t KnxTelegram::getFirstDataByte() {
 }
 
 bool KnxTelegram::getBool() {
-  if (getPayloadLength() != 2) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return (getFirstDataByte() & B00000001);
+  return get<KnxDpt1>();
 }
 
 uint8_t KnxTelegram::get4BitIntValue() {
-  if (getPayloadLength() != 2) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return (getFirstDataByte() & B00001111);
+  return get<KnxDpt3>();
 }
 
 bool KnxTelegram::get4BitDirectionValue() {
-  if (getPayloadLength() != 2) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return ((getFirstDataByte() & B00001000)) >> 3;
+  return (get<KnxDpt3>() & B00001000) >> 3;
 }
 
 uint8_t KnxTelegram::get4BitStepsValue() {
-  if (getPayloadLength() != 2) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return (getFirstDataByte() & B00000111);
+  return (get<KnxDpt3>() & B00000111);
 }
 
 void KnxTelegram::set1ByteIntValue(int8_t value) {
-  setPayloadLength(3);
-  buffer[8] = (value & 0xFF);
+  set<KnxDpt6>(value);
 }
 
 void KnxTelegram::set1ByteUIntValue(uint8_t value) {
-  setPayloadLength(3);
-  buffer[8] = (value & 0xFF);
+  set<KnxDpt5>(value);
 }
 
 int8_t KnxTelegram::get1ByteIntValue() {
-  if (getPayloadLength() != 3) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return (int8_t) (buffer[8] & 0xFF);
+  return get<KnxDpt6>();
 }
 
 uint8_t KnxTelegram::get1ByteUIntValue() {
-  if (getPayloadLength() != 3) {
-    // Wrong payload length
-    return 0;
-  }
-
-  return (uint8_t) (buffer[8] & 0xFF);
+  return get<KnxDpt5>();
 }
 
 void KnxTelegram::set2ByteIntValue(int16_t value) {
-  setPayloadLength(4);
-
-  buffer[8] = (value >> 8) & 0xFF;
-  buffer[9] = value & 0xFF;
+  set<KnxDpt8>(value);
 }
 
 int16_t KnxTelegram::get2ByteIntValue() {
-  if (getPayloadLength() != 4) {
-    // Wrong payload length
-    return 0;
-  }
-  int16_t value = int(buffer[8] << 8) + int(buffer[9]);
-
-  return (value);
+  return get<KnxDpt8>();
 }
 
-
 void KnxTelegram::set2ByteUIntValue(uint16_t value) {
-  setPayloadLength(4);
-
-  buffer[8] = (value >> 8) & 0xFF;
-  buffer[9] = value & 0xFF;
+  set<KnxDpt7>(value);
 }
 
 uint16_t KnxTelegram::get2ByteUIntValue() {
-  if (getPayloadLength() != 4) {
-    // Wrong payload length
-    return 0;
-  }
-  uint16_t value = (((uint16_t)buffer[8]) << 8) + buffer[9];
-
-  return (value);
+  return get<KnxDpt7>();
 }
 
-
-
 void KnxTelegram::set4ByteIntValue(int32_t value) {
-  setPayloadLength(6);
-
-  buffer[8]  = (value  >> 24) & 0xFF;
-  buffer[9]  = (value  >> 16) & 0xFF;
-  buffer[10] = (value  >> 8) & 0xFF;
-  buffer[11] = (value & 0xFF);
+  set<KnxDpt13>(value);
 }
 
-
 int32_t KnxTelegram::get4ByteIntValue() {
-  if (getPayloadLength() != 6) {
-    // Wrong payload length
-    return 0;
-  }
-
-  int32_t value = buffer[8];
-  value = (value << 8) + buffer[9];
-  value = (value << 8) + buffer[10];
-  value = (value << 8) + buffer[11];
-
-  return (value);
+  return get<KnxDpt13>();
 }
 
-
 void KnxTelegram::set4ByteUIntValue(uint32_t value) {
-  setPayloadLength(6);
-
-  buffer[8]  = (value  >> 24) & 0xFF;
-  buffer[9]  = (value  >> 16) & 0xFF;
-  buffer[10] = (value >> 8) & 0xFF;
-  buffer[11] = (value & 0xFF);
+  set<KnxDpt12>(value);
 }
 
-
 uint32_t KnxTelegram::get4ByteUIntValue() {
-  if (getPayloadLength() != 6) {
-    // Wrong payload length
-    return 0;
-  }
-  //TODO: check if this is correct
-  uint32_t value = buffer[8];
-  value = value << 8 + buffer[9];
-  value = value << 8 + buffer[10];
-  value = value << 8 + buffer[11];
-
-  return (value);
+  return get<KnxDpt12>();
 }
 
-
 void KnxTelegram::set2ByteFloatValue(float value) {
-  setPayloadLength(4);
+  set<KnxDpt9>(value);
+}
 
-  float v = value * 100.0f;
-  int exponent = 0;
-  for (; v < -2048.0f; v /= 2) exponent++;
-  for (; v > 2047.0f; v /= 2) exponent++;
-//  long m = round(v) & 0x7FF;
-  long m = lround(v) & 0x7FF;
-  short msb = (short) (exponent << 3 | m >> 8);
-  if (value < 0.0f) msb |= 0x80;
-  buffer[8] = msb;
-  buffer[9] = (uint8_t)m;
+void KnxTelegram::encode2ByteFloat(float value, uint8_t* aBuffer) {
+  KnxDpt9::encode(value, aBuffer);
 }
 
 float KnxTelegram::get2ByteFloatValue() {
-  if (getPayloadLength() != 4) {
-    // Wrong payload length
-    return 0;
-  }
-
-  int exponent = (buffer[8] & B01111000) >> 3;
-  int mantissa = ((buffer[8] & B00000111) << 8) | (buffer[9]);
+  return get<KnxDpt9>();
+}
 
-  if (buffer[8] & B10000000) {
-    return ((-2048 + mantissa) * 0.01) * pow(2.0, exponent); // Thanks to Rouven Raudzus for the note
-  }
+void KnxTelegram::set2ByteFloatHundredths(int32_t value) {
+  set<KnxDpt9Hundredths>(value);
+}
 
-  return (mantissa * 0.01) * pow(2.0, exponent);
+int32_t KnxTelegram::get2ByteFloatHundredths() {
+  return get<KnxDpt9Hundredths>();
 }
 
 void KnxTelegram::set3ByteTime(uint8_t weekday, uint8_t hour, uint8_t minute, uint8_t second) {
-  setPayloadLength(5);
-
-  // Move the weekday by 5 bits to the left
-  weekday = weekday << 5;
-
-  // Buffer [8] bit 5-7 for weekday, bit 0-4 for hour
-  buffer[8] = (weekday & B11100000) + (hour & B00011111);
-
-  // Buffer [9] bit 6-7 empty, bit 0-5 for minutes
-  buffer[9] =  minute & B00111111;
-
-  // Buffer [10] bit 6-7 empty, bit 0-5 for seconds
-  buffer[10] = second & B00111111;
+  KnxTime time = { weekday, hour, minute, second };
+  set<KnxDpt10>(time);
 }
 
 uint8_t KnxTelegram::get3ByteWeekdayValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[8] & B11100000) >> 5;
+  return get<KnxDpt10>().weekday;
 }
 
 uint8_t KnxTelegram::get3ByteHourValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[8] & B00011111);
+  return get<KnxDpt10>().hour;
 }
 
 uint8_t KnxTelegram::get3ByteMinuteValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[9] & B00111111);
+  return get<KnxDpt10>().minute;
 }
 
 uint8_t KnxTelegram::get3ByteSecondValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[10] & B00111111);
+  return get<KnxDpt10>().second;
 }
 
 void KnxTelegram::set3ByteDate(uint8_t day, uint8_t month, uint8_t year) {
-  setPayloadLength(5);
-
-  // Buffer [8] bit 5-7 empty, bit 0-4 for month days
-  buffer[8] = day & B00011111;
-
-  // Buffer [9] bit 4-7 empty, bit 0-3 for months
-  buffer[9] =  month & B00001111;
-
-  // Buffer [10] fill with year
-  buffer[10] = year;
+  KnxDate date = { day, month, year };
+  set<KnxDpt11>(date);
 }
 
 uint8_t KnxTelegram::get3ByteDayValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[8] & B00011111);
+  return get<KnxDpt11>().day;
 }
 
 uint8_t KnxTelegram::get3ByteMonthValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[9] & B00001111);
+  return get<KnxDpt11>().month;
 }
 
 uint8_t KnxTelegram::get3ByteYearValue() {
-  if (getPayloadLength() != 5) {
-    // Wrong payload length
-    return 0;
-  }
-  return (buffer[10]);
+  return get<KnxDpt11>().year;
 }
 
 void KnxTelegram::set4ByteFloatValue(float value) {
-  setPayloadLength(6);
-
-  uint8_t b[4];
-  float *f = (float*)(void*) & (b[0]);
-  *f = value;
-
-  buffer[8 + 3] = b[0];
-  buffer[8 + 2] = b[1];
-  buffer[8 + 1] = b[2];
-  buffer[8 + 0] = b[3];
+  set<KnxDpt14>(value);
 }
 
 float KnxTelegram::get4ByteFloatValue() {
-  if (getPayloadLength() != 6) {
-    // Wrong payload length
-    return 0;
-  }
-  uint8_t b[4];
-  b[0] = buffer[8 + 3];
-  b[1] = buffer[8 + 2];
-  b[2] = buffer[8 + 1];
-  b[3] = buffer[8 + 0];
-  float *f = (float*)(void*) & (b[0]);
-  float  r = *f;
-  return r;
+  return get<KnxDpt14>();
 }
 
 void KnxTelegram::set14ByteValue(String value) {
-    setPayloadLength(16);
-
-    // Define
-    char _load[15];
-    memset(_load, 0, 15);
-
-    // Make out of value the Chararray
-    value.toCharArray(_load, 15); // Must be 15 - because it completes with 0
-    for (uint8_t i = 0; i < 14; i++)
-    {
-        buffer[8 + i]  = _load[i];
-    }
+  set<KnxDpt16>(value.c_str());
 }
 
 String KnxTelegram::get14ByteValue() {
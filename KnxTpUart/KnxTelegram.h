@@ -11,6 +11,7 @@
 #define KnxTelegram_h
 
 #include "Arduino.h"
+#include "KnxDpt.h"
 
 /**
  * A KNX Group address is a 16 bit number separated into 3 fields.
@@ -106,6 +107,9 @@ union KNX_ADDR
  */
 #define MAX_KNX_TELEGRAM_SIZE 23
 
+// Size of a telegram encoded for the TP-UART (control and data byte per telegram byte)
+#define TPUART_FRAME_MAX_SIZE (2 * MAX_KNX_TELEGRAM_SIZE)
+
 /**
  * The KNX telegram header size.
  * This should never be changed!
@@ -479,11 +483,30 @@ class KnxTelegram {
      * @param aValue the value to set into payload data.
      */
     void set2ByteFloatValue(float aValue);
+
+    /**
+     * Encode a 2 byte float (DPT-9) the way it is stored in the payload.
+     * @param aValue the value to encode.
+     * @param aBuffer the 2 bytes to write to.
+     */
+    static void encode2ByteFloat(float aValue, uint8_t* aBuffer);
     /**
      * @return the payload data as 2 byte float.
      */
     float get2ByteFloatValue();
 
+    /**
+     * Set the payload data to be a 2 byte float given in hundredths, e.g. 2150 for 21.50.
+     * This needs no floating point arithmetic.
+     * @param aValue the value in hundredths.
+     */
+    void set2ByteFloatHundredths(int32_t aValue);
+
+    /**
+     * @return the payload data as 2 byte float in hundredths.
+     */
+    int32_t get2ByteFloatHundredths();
+
     /**
      * Set the payload data to be a 3 byte time value.
      * @param aWeekday the weekday (0-6)
@@ -568,6 +591,32 @@ class KnxTelegram {
      */
     void setValue(uint8_t* aBuffer, uint8_t aSize);
 
+    /**
+     * Set the payload to a value of the given datapoint type, e.g. set<KnxDpt9>(21.5).
+     * The payload length is set to fit the type, see KnxDpt.h.
+     * @param aValue the value to set into payload data.
+     */
+    template<typename Dpt>
+    void set(typename Dpt::Type aValue)
+    {
+        setPayloadLength(Dpt::Size + 2);
+        Dpt::encode(aValue, buffer + (Dpt::Size == 0 ? 7 : 8));
+    }
+
+    /**
+     * Read the payload as value of the given datapoint type, e.g. get<KnxDpt9>().
+     * @return the value or a zero value if the payload length does not match the type.
+     */
+    template<typename Dpt>
+    typename Dpt::Type get()
+    {
+        if (getPayloadLength() != Dpt::Size + 2) {
+            // Wrong payload length
+            return typename Dpt::Type();
+        }
+        return Dpt::decode(buffer + (Dpt::Size == 0 ? 7 : 8));
+    }
+
     /**
      * Create and assign the checksum to the telegram buffer. This need to be called befor sending the telegram.
      */
@@ -0,0 +1,122 @@
+// File: KnxTelegramTemplate.cpp
+// A telegram kept encoded for the TP-UART, only the value is patched before sending.
+
+#include "KnxTelegramTemplate.h"
+#include "KnxTpUart.h"
+
+// Offset of the first value byte of a long telegram
+#define KNX_TEMPLATE_VALUE_OFFSET 8
+
+KnxTelegramTemplate::KnxTelegramTemplate()
+{
+    mFrameLength = 0;
+}
+
+KnxTelegramTemplate::KnxTelegramTemplate(KnxTelegram* aTelegram)
+{
+    init(aTelegram);
+}
+
+void KnxTelegramTemplate::init(KnxTelegram* aTelegram)
+{
+    mFrameLength = KnxTpUart::encodeTelegram(aTelegram, mFrame);
+
+    // the checksum of the telegram may not be set yet, this is the only full pass
+    uint8_t checksum = 0xFF;
+    for (uint8_t i = 1; i < mFrameLength - 2; i += 2)
+    {
+        checksum ^= mFrame[i];
+    }
+    mFrame[mFrameLength - 1] = checksum;
+}
+
+void KnxTelegramTemplate::patch(uint8_t aIndex, uint8_t aByte)
+{
+    if (mFrameLength == 0)
+    {
+        // not initialized, there is no checksum to update
+        return;
+    }
+    uint8_t* pos = &mFrame[2 * aIndex + 1];
+    mFrame[mFrameLength - 1] ^= *pos ^ aByte;
+    *pos = aByte;
+}
+
+void KnxTelegramTemplate::setFirstDataByte(uint8_t aValue)
+{
+    patch(7, (getTelegramByte(7) & B11000000) | (aValue & B00111111));
+}
+
+void KnxTelegramTemplate::setBoolValue(bool aValue)
+{
+    set<KnxDpt1>(aValue);
+}
+
+void KnxTelegramTemplate::setValue(const uint8_t* aValue, uint8_t aSize)
+{
+    if (mFrameLength == 0)
+    {
+        return;
+    }
+    // the value ends in front of the checksum
+    uint8_t end = mFrameLength / 2 - 1;
+    for (uint8_t i = 0; i < aSize && KNX_TEMPLATE_VALUE_OFFSET + i < end; i++)
+    {
+        patch(KNX_TEMPLATE_VALUE_OFFSET + i, aValue[i]);
+    }
+}
+
+void KnxTelegramTemplate::set1ByteIntValue(int8_t aValue)
+{
+    set<KnxDpt6>(aValue);
+}
+
+void KnxTelegramTemplate::set1ByteUIntValue(uint8_t aValue)
+{
+    set<KnxDpt5>(aValue);
+}
+
+void KnxTelegramTemplate::set2ByteIntValue(int16_t aValue)
+{
+    set<KnxDpt8>(aValue);
+}
+
+void KnxTelegramTemplate::set2ByteUIntValue(uint16_t aValue)
+{
+    set<KnxDpt7>(aValue);
+}
+
+void KnxTelegramTemplate::set2ByteFloatValue(float aValue)
+{
+    set<KnxDpt9>(aValue);
+}
+
+void KnxTelegramTemplate::set4ByteIntValue(int32_t aValue)
+{
+    set<KnxDpt13>(aValue);
+}
+
+void KnxTelegramTemplate::set4ByteUIntValue(uint32_t aValue)
+{
+    set<KnxDpt12>(aValue);
+}
+
+void KnxTelegramTemplate::set4ByteFloatValue(float aValue)
+{
+    set<KnxDpt14>(aValue);
+}
+
+uint8_t KnxTelegramTemplate::getTelegramByte(uint8_t aIndex)
+{
+    return mFrame[2 * aIndex + 1];
+}
+
+uint8_t* KnxTelegramTemplate::getFrame()
+{
+    return mFrame;
+}
+
+uint8_t KnxTelegramTemplate::getFrameLength()
+{
+    return mFrameLength;
+}
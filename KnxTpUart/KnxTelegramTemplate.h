@@ -0,0 +1,120 @@
+// File: KnxTelegramTemplate.h
+// A telegram kept encoded for the TP-UART, only the value is patched before sending.
+
+#ifndef KnxTelegramTemplate_h
+#define KnxTelegramTemplate_h
+
+#include "Arduino.h"
+#include "KnxTelegram.h"
+
+/**
+ * A telegram to a fixed target with a fixed command and value size, stored as complete TP-UART frame.
+ * Setting a value only replaces the value bytes inside the frame and updates the checksum
+ * incrementally (checksum XOR old byte XOR new byte), header and encoding are done once in #init().
+ * Send it with KnxTpUart::sendTemplate().
+ */
+class KnxTelegramTemplate
+{
+  public:
+    /**
+     * Create an empty template, #init() has to be called before it can be sent.
+     */
+    KnxTelegramTemplate();
+
+    /**
+     * Create a template from a telegram, see #init().
+     */
+    KnxTelegramTemplate(KnxTelegram* aTelegram);
+
+    /**
+     * Encode the given telegram into the template and calculate its checksum.
+     * The telegram defines target, command, priority and the value size (payload length), e.g.:
+     * <pre>
+     * knx.buildGroupTelegram(&telegram, KNX_COMMAND_WRITE, KNX_GA(1,2,3));
+     * telegram.set2ByteFloatValue(0);
+     * temperature.init(&telegram);
+     * </pre>
+     * @param aTelegram the telegram, it is not modified.
+     */
+    void init(KnxTelegram* aTelegram);
+
+    /**
+     * Set the value of a short telegram (up to 6 bit, e.g. DPT-1 to DPT-3).
+     */
+    void setFirstDataByte(uint8_t aValue);
+
+    /**
+     * Set a boolean value (DPT-1) of a short telegram.
+     */
+    void setBoolValue(bool aValue);
+
+    /**
+     * Set the value bytes of a long telegram (behind the command), excess bytes are ignored.
+     * @param aValue the value as stored in the payload.
+     * @param aSize the number of bytes.
+     */
+    void setValue(const uint8_t* aValue, uint8_t aSize);
+
+    /**
+     * Set a value of the given datapoint type, e.g. set<KnxDpt9>(21.5).
+     * The template has to be initialized with a telegram of the same type, see KnxDpt.h.
+     */
+    template<typename Dpt>
+    void set(typename Dpt::Type aValue)
+    {
+        if (Dpt::Size == 0)
+        {
+            uint8_t data = getTelegramByte(7);
+            Dpt::encode(aValue, &data);
+            patch(7, data);
+        }
+        else
+        {
+            uint8_t value[Dpt::Size == 0 ? 1 : Dpt::Size];
+            Dpt::encode(aValue, value);
+            setValue(value, Dpt::Size);
+        }
+    }
+
+    void set1ByteIntValue(int8_t aValue);
+    void set1ByteUIntValue(uint8_t aValue);
+    void set2ByteIntValue(int16_t aValue);
+    void set2ByteUIntValue(uint16_t aValue);
+    void set2ByteFloatValue(float aValue);
+    void set4ByteIntValue(int32_t aValue);
+    void set4ByteUIntValue(uint32_t aValue);
+    void set4ByteFloatValue(float aValue);
+
+    /**
+     * @param aIndex the offset in the telegram (not the frame).
+     * @return the telegram byte at the given offset.
+     */
+    uint8_t getTelegramByte(uint8_t aIndex);
+
+    /**
+     * @return the encoded frame, ready to be written to the TP-UART.
+     */
+    uint8_t* getFrame();
+
+    /**
+     * @return the length of the encoded frame, 0 if the template was not initialized.
+     */
+    uint8_t getFrameLength();
+
+  private:
+    /**
+     * Replace a telegram byte in the frame and update the checksum, nothing is done before #init().
+     * @param aIndex the offset in the telegram.
+     * @param aByte the new value.
+     */
+    void patch(uint8_t aIndex, uint8_t aByte);
+
+    /**
+     * The frame as written by KnxTpUart::encodeTelegram().
+     */
+    uint8_t mFrame[TPUART_FRAME_MAX_SIZE];
+
+    uint8_t mFrameLength;
+};
+
+#endif
@@ -9,6 +9,9 @@
 
 #include "KnxTpUart.h"
 
+// The clock of all instances that were not given one
+static KnxClock sArduinoClock;
+
 KnxTpUart::KnxTpUart(Stream* sport, String aAddress)
 {
     _serialport = sport;
@@ -26,19 +29,69 @@ KnxTpUart::KnxTpUart(Stream* sport, uint16_t aAddress)
 void KnxTpUart::init(void)
 {
     _tg = new KnxTelegram();
+    mClock = &sArduinoClock;
     _listen_to_broadcasts  = false;
     mTelegramCheckCallback = NULL;
 
-    // KNX telegram can be 23 byte --> 184 bit --> ~19.1ms in 9600 Bit/s TP
-    // as we read in a loop we allow a telegram to be separated into two blocks of 10ms timeout
-    _serialport->setTimeout(SERIAL_READ_TIMEOUT_MS);
+    for (uint8_t i = 0; i < KNX_RX_QUEUE_SIZE; i++)
+    {
+        mRxSlotState[i] = KNX_RX_SLOT_FREE;
+    }
+    mRxQueueHead          = 0;
+    mRxQueueCount         = 0;
+    mRxQueueOverflowCount = 0;
+    mRxDelivered          = 0;
+    mRxSlot               = 0;
+    mRxTelegram           = &mRxSlots[0];
+
+    mSendPending      = false;
+    mSendWaiting      = false;
+    mSendConfirmation = -1;
+    mTxResync         = false;
+    mTxResyncTime     = 0;
+    mResetIndicationPending = false;
+    #ifndef KNX_SUPPORT_TX_QUEUE
+        mTxUnconfirmed = 0;
+    #endif
 
-    #ifdef KNX_SUPPORT_LISTEN_GAS
-        mListenGAs      = NULL;
-        mListenGAsCount = 0;
-        mListenGAsMax   = 0;
+    mTxMaxAttempts  = KNX_TX_MAX_ATTEMPTS;
+    mTxRetryBackoff = KNX_TX_RETRY_BACKOFF_MS;
+    resetSendStatistics();
+
+    mTxRateLimit   = KNX_TX_MAX_TELEGRAMS_PER_SECOND;
+    mTxLoadLimit   = KNX_TX_MAX_BUS_LOAD_PERCENT;
+    mTxCredit      = KNX_TX_BURST_MS * 1000L;
+    mTxCreditTime  = mClock->getMicros();
+
+    mRxState        = KNX_RX_IDLE;
+    mRxOffset       = 0;
+    mRxLength       = 0;
+    mRxInterested   = false;
+    mRxLastByteTime = 0;
+    mRxFrameStart   = 0;
+    mRxFrameTimeout = 0;
+    setTimeouts(KNX_HOST_BAUDRATE, KNX_TIMEOUT_SLACK_US);
+
+    #ifdef KNX_SUPPORT_GROUP_HANDLERS
+        mRxHandler            = NULL;
+        mRxHandlerContext     = NULL;
+        mListenedGroupHandler = false;
     #endif
 
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        for (uint8_t i = 0; i < KNX_TX_QUEUE_SIZE; i++)
+        {
+            mTxSlotUsed[i] = false;
+        }
+        mTxCount      = 0;
+        mTxActive     = false;
+        mTxStartTime  = 0;
+        mTxQueuedSend = false;
+        mTxRetryTime  = 0;
+        mTxRetryDelay = 0;
+    #endif
+    // KNX telegram can be 23 byte --> 184 bit --> ~19.1ms in 9600 Bit/s TP
+    // the telegram is read incrementally without blocking reads, an overdue byte aborts it, see receive()
 }
 
 void KnxTpUart::setListenToBroadcasts(bool listen)
@@ -50,6 +103,12 @@ void KnxTpUart::uartReset()
 {
     const uint8_t sendByte = TPUART_RESET;
     _serialport->write(sendByte);
+    mTxResync     = true;
+    mTxResyncTime = mClock->getMicros();
+    #ifndef KNX_SUPPORT_TX_QUEUE
+        // the reset discards the NCD confirms as well
+        mTxUnconfirmed = 0;
+    #endif
 }
 
 void KnxTpUart::uartStateRequest()
@@ -70,61 +129,337 @@ void KnxTpUart::setIndividualAddress(uint16_t aAddress)
 
 KnxTpUartSerialEventType KnxTpUart::serialEvent()
 {
-    while (_serialport->available() > 0)
+    // the telegram handed out by the previous call is no longer in use
+    releaseReceivedTelegram();
+
+    if (mResetIndicationPending && mRxQueueCount == 0)
+    {
+        // seen while a send waited, reported behind the telegrams received before it
+        mResetIndicationPending = false;
+        return TPUART_RESET_INDICATION;
+    }
+
+    KnxTpUartSerialEventType res = receive();
+
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        serviceSendQueue();
+    #endif
+
+    if (mRxQueueCount > 0 && res != TIMEOUT)
     {
-        checkErrors();
+        res = deliverReceivedTelegram();
+    }
+
+    #if defined(TPUART_DEBUG)
+        if (res == KNX_TELEGRAM)
+        {
+            TPUART_DEBUG_PORT.println("Event KNX_TELEGRAM");
+        }
+        else if (res == DISPATCHED_KNX_TELEGRAM)
+        {
+            TPUART_DEBUG_PORT.println("Event DISPATCHED_KNX_TELEGRAM");
+        }
+        else if (res == IRRELEVANT_KNX_TELEGRAM)
+        {
+            TPUART_DEBUG_PORT.println("Event IRRELEVANT_KNX_TELEGRAM");
+        }
+        else if (res == TPUART_RESET_INDICATION)
+        {
+            TPUART_DEBUG_PORT.println("Event TPUART_RESET_INDICATION");
+        }
+        else if (res == UNKNOWN)
+        {
+            TPUART_DEBUG_PORT.println("Event UNKNOWN");
+        }
+    #endif
+    return res;
+}
 
-        int incomingByte = _serialport->peek();
-        printByte(incomingByte);
+KnxTpUartSerialEventType KnxTpUart::receive()
+{
+    // a byte waiting in the UART is not overdue, even if the host looks at it late
+    if (mRxState != KNX_RX_IDLE && rxAvailable() == 0)
+    {
+        unsigned long now = mClock->getMicros();
+        if ((now - mRxLastByteTime) > mRxByteTime + mTimeoutSlack || (now - mRxFrameStart) > mRxFrameTimeout)
+        {
+            // telegram stalled, drop it and resynchronize with the UART
+            mRxSlotState[mRxSlot] = KNX_RX_SLOT_FREE;
+            mRxState = KNX_RX_IDLE;
+            uartReset();
+            #if defined(TPUART_DEBUG)
+                TPUART_DEBUG_PORT.println("Read Timeout");
+            #endif
+            return TIMEOUT;
+        }
+    }
 
-        if (isKNXControlByte(incomingByte & 0xFF))
+    // receive as many telegrams as available, each one is acknowledged and queued on the fly
+    while (rxAvailable() > 0)
+    {
+        if (mRxState == KNX_RX_IDLE)
         {
-    	    KnxTpUartSerialEventType readRes = readKNXTelegram();
-            if (readRes == KNX_TELEGRAM)
+            checkErrors();
+
+            int incomingByte = rxPeek();
+            printByte(incomingByte);
+
+            if (isDiscardedConfirmation(incomingByte))
             {
-				#if defined(TPUART_DEBUG)
-            		TPUART_DEBUG_PORT.println("Event KNX_TELEGRAM");
-				#endif
-				return readRes;
+                // it must not be taken for the confirmation of a telegram written after the reset
+                rxRead();
+                continue;
+            }
+
+            #ifndef KNX_SUPPORT_TX_QUEUE
+                if (mTxUnconfirmed > 0 && (incomingByte == TPUART_SEND_SUCCESS || incomingByte == TPUART_SEND_NOT_SUCCESS))
+                {
+                    // confirmation of a NCD confirm, it was written before any telegram still waiting
+                    rxRead();
+                    mTxUnconfirmed--;
+                    continue;
+                }
+            #endif
+
+            #ifdef KNX_SUPPORT_TX_QUEUE
+                if (mTxActive && (incomingByte == TPUART_SEND_SUCCESS || incomingByte == TPUART_SEND_NOT_SUCCESS))
+                {
+                    // confirmation of the queued telegram, this does not disturb the order of received telegrams
+                    rxRead();
+                    completeQueuedTelegram((incomingByte == TPUART_SEND_SUCCESS) ? KNX_SEND_CONFIRMED : KNX_SEND_NOT_CONFIRMED);
+                    continue;
+                }
+            #endif
+
+            if (mSendPending && (incomingByte == TPUART_SEND_SUCCESS || incomingByte == TPUART_SEND_NOT_SUCCESS))
+            {
+                // confirmation a blocking send waits for
+                rxRead();
+                mSendConfirmation = incomingByte;
+                return UNKNOWN;
             }
-            else if (readRes == IRRELEVANT_KNX_TELEGRAM)
+
+            // while a send waits the bytes must be consumed, if all buffers are in use the oldest queued telegram is dropped
+            if (isKNXControlByte(incomingByte & 0xFF))
             {
-				#if defined(TPUART_DEBUG)
-					TPUART_DEBUG_PORT.println("Event IRRELEVANT_KNX_TELEGRAM");
-				#endif
-				return readRes;
+                if (!hasFreeReceiveSlot() && !mSendWaiting)
+                {
+                    // leave the telegram in the UART until the queued ones were handed out
+                    return UNKNOWN;
+                }
             }
-            else if (readRes == TIMEOUT)
+            else
             {
-				#if defined(TPUART_DEBUG)
-					TPUART_DEBUG_PORT.println("Read Timeout");
-					return readRes;
-				#endif
+                if (mRxQueueCount > 0 && !mSendWaiting)
+                {
+                    // report the queued telegrams first to keep the order of events
+                    return UNKNOWN;
+                }
+
+                rxRead();
+                if (incomingByte == TPUART_RESET_INDICATION_BYTE)
+                {
+                    if (!mTxResync)
+                    {
+                        resetIndicated();
+                    }
+                    mTxResync = false;
+                    if (mSendWaiting)
+                    {
+                        // the caller of the wait does not look at events, serialEvent() reports it later
+                        mResetIndicationPending = true;
+                    }
+                    return TPUART_RESET_INDICATION;
+                }
+                return UNKNOWN;
             }
         }
-        else if (incomingByte == TPUART_RESET_INDICATION_BYTE)
+
+        readKNXTelegram();
+    }
+
+    return (mRxState == KNX_RX_IDLE) ? UNKNOWN : INCOMPLETE_KNX_TELEGRAM;
+}
+
+bool KnxTpUart::hasFreeReceiveSlot()
+{
+    for (uint8_t i = 0; i < KNX_RX_QUEUE_SIZE; i++)
+    {
+        if (mRxSlotState[i] == KNX_RX_SLOT_FREE)
         {
-            serialRead();
-			#if defined(TPUART_DEBUG)
-			    TPUART_DEBUG_PORT.println("Event TPUART_RESET_INDICATION");
-			#endif
-		    return TPUART_RESET_INDICATION;
+            return true;
         }
-        else
+    }
+    return false;
+}
+
+uint8_t KnxTpUart::acquireReceiveSlot()
+{
+    for (uint8_t i = 0; i < KNX_RX_QUEUE_SIZE; i++)
+    {
+        if (mRxSlotState[i] == KNX_RX_SLOT_FREE)
         {
-            serialRead();
-            #if defined(TPUART_DEBUG)
-                TPUART_DEBUG_PORT.println("Event UNKNOWN");
-            #endif
-            return UNKNOWN;
+            mRxSlotState[i] = KNX_RX_SLOT_RECEIVING;
+            return i;
         }
     }
-    #if defined(TPUART_DEBUG)
-        TPUART_DEBUG_PORT.println("Event UNKNOWN");
+
+    // all slots in use, sacrifice the oldest queued telegram
+    uint8_t slot  = mRxQueue[mRxQueueHead];
+    mRxQueueHead  = (mRxQueueHead + 1) % KNX_RX_QUEUE_SIZE;
+    mRxQueueCount--;
+    mRxQueueOverflowCount++;
+    mRxSlotState[slot] = KNX_RX_SLOT_RECEIVING;
+    return slot;
+}
+
+void KnxTpUart::queueReceivedTelegram()
+{
+    mRxQueue[(mRxQueueHead + mRxQueueCount) % KNX_RX_QUEUE_SIZE] = mRxSlot;
+    mRxQueueCount++;
+    mRxSlotState[mRxSlot] = KNX_RX_SLOT_QUEUED;
+}
+
+KnxTpUartSerialEventType KnxTpUart::deliverReceivedTelegram()
+{
+    mRxDelivered  = mRxQueue[mRxQueueHead];
+    mRxQueueHead  = (mRxQueueHead + 1) % KNX_RX_QUEUE_SIZE;
+    mRxQueueCount--;
+    mRxSlotState[mRxDelivered] = KNX_RX_SLOT_DELIVERED;
+
+    if (!mRxSlotInterested[mRxDelivered])
+    {
+        return IRRELEVANT_KNX_TELEGRAM;
+    }
+
+    KnxTelegram* telegram = &mRxSlots[mRxDelivered];
+    if (telegram->getCommunicationType() == KNX_COMM_NCD)
+    {
+        // Thanks to Katja Blankenheim for the help
+        sendNCDPosConfirm(telegram->getSequenceNumber(), telegram->getSourceAddress());
+    }
+
+    #ifdef KNX_SUPPORT_GROUP_HANDLERS
+        if (mRxSlotHandler[mRxDelivered] != NULL)
+        {
+            mRxSlotHandler[mRxDelivered](telegram, mRxSlotHandlerContext[mRxDelivered]);
+            return DISPATCHED_KNX_TELEGRAM;
+        }
+    #endif
+
+    return KNX_TELEGRAM;
+}
+
+void KnxTpUart::releaseReceivedTelegram()
+{
+    if (mRxSlotState[mRxDelivered] == KNX_RX_SLOT_DELIVERED)
+    {
+        mRxSlotState[mRxDelivered] = KNX_RX_SLOT_FREE;
+    }
+}
+
+uint8_t KnxTpUart::getReceivedTelegramCount()
+{
+    return mRxQueueCount;
+}
+
+uint16_t KnxTpUart::getReceiveQueueOverflowCount()
+{
+    return mRxQueueOverflowCount;
+}
+
+int KnxTpUart::rxAvailable()
+{
+    #ifdef KNX_SUPPORT_RX_RING
+        // the bytes of the ring came first, the Stream only has bytes if no interrupt fills the ring
+        return mRxRing.available() + _serialport->available();
+    #else
+        return _serialport->available();
+    #endif
+}
+
+int KnxTpUart::rxPeek()
+{
+    #ifdef KNX_SUPPORT_RX_RING
+        if (mRxRing.available() > 0)
+        {
+            return mRxRing.peek();
+        }
+    #endif
+    return _serialport->peek();
+}
+
+int KnxTpUart::rxRead()
+{
+    #ifdef KNX_SUPPORT_RX_RING
+        if (mRxRing.available() > 0)
+        {
+            return mRxRing.read();
+        }
+    #endif
+    return _serialport->read();
+}
+
+uint8_t KnxTpUart::rxReadBytes(uint8_t* aBuffer, uint8_t aCount)
+{
+    uint8_t count = 0;
+    #ifdef KNX_SUPPORT_RX_RING
+        count = mRxRing.read(aBuffer, aCount);
+        if (count == aCount)
+        {
+            return count;
+        }
+    #endif
+    // the caller never asks for more than is available, so this does not block
+    return count + _serialport->readBytes(aBuffer + count, aCount - count);
+}
+
+#ifdef KNX_SUPPORT_RX_RING
+bool KnxTpUart::pushReceivedByte(uint8_t aByte)
+{
+    return mRxRing.push(aByte);
+}
+
+uint8_t KnxTpUart::getReceiveOverrunCount()
+{
+    return mRxRing.getOverrunCount();
+}
+#endif
+
+void KnxTpUart::resetIndicated()
+{
+    // the TP-UART reset itself, the telegrams given to it will never be confirmed
+    if (mSendPending)
+    {
+        mSendConfirmation = TPUART_RESET_INDICATION_BYTE;
+    }
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        if (mTxActive)
+        {
+            completeQueuedTelegram(KNX_SEND_NOT_CONFIRMED);
+        }
+    #else
+        mTxUnconfirmed = 0;
     #endif
-    return UNKNOWN;
 }
 
+bool KnxTpUart::isDiscardedConfirmation(int aByte)
+{
+    if (!mTxResync || (aByte != TPUART_SEND_SUCCESS && aByte != TPUART_SEND_NOT_SUCCESS))
+    {
+        return false;
+    }
+    if ((mClock->getMicros() - mTxResyncTime) > getByteTimeout())
+    {
+        // the reset indication got lost, do not ignore confirmations forever
+        mTxResync = false;
+        return false;
+    }
+    #if defined(TPUART_DEBUG)
+        TPUART_DEBUG_PORT.println("Confirmation discarded by reset");
+    #endif
+    return true;
+}
 
 bool KnxTpUart::isKNXControlByte(uint8_t aByte)
 {
@@ -205,116 +540,193 @@ void KnxTpUart::printByte(uint8_t aByte)
 
 KnxTpUartSerialEventType KnxTpUart::readKNXTelegram()
 {
-    // read 9 byte (minimum telegram length)
-	size_t offs = 0;
+    while (rxAvailable() > 0)
+    {
+        mRxLastByteTime = mClock->getMicros();
+        uint8_t* buffer = mRxTelegram->getBuffer();
 
-	while (offs < 9)
-	{
-		int read = _serialport->readBytes(_tg->getBuffer() + offs, 9 - offs);
-		if (read > 0)
-		{
-			// at least one byte received
-			offs += read;
-		}
-		else
-		{
-			//timeout
-			// we do a uart reset and return a false
-			uartReset();
-			return TIMEOUT;
-		}
-	}
+        switch (mRxState)
+        {
+            case KNX_RX_IDLE:
+                // control byte, starts a new telegram in a free slot
+                mRxSlot     = acquireReceiveSlot();
+                mRxTelegram = &mRxSlots[mRxSlot];
+                buffer      = mRxTelegram->getBuffer();
+                buffer[0]   = rxRead();
+                mRxOffset  = 1;
+                mRxState   = KNX_RX_HEADER;
+
+                // the length is not known yet, the longest telegram has to be complete in time
+                mRxFrameStart   = mRxLastByteTime;
+                mRxFrameTimeout = MAX_KNX_TELEGRAM_SIZE * mRxByteTime + mTimeoutSlack;
+                break;
+
+            case KNX_RX_HEADER:
+                // source and target address
+                buffer[mRxOffset++] = rxRead();
+                if (mRxOffset == KNX_TELEGRAM_HEADER_SIZE - 1)
+                {
+                    mRxState = KNX_RX_LENGTH;
+                }
+                break;
+
+            case KNX_RX_LENGTH:
+                // address type, routing counter and payload length
+                buffer[mRxOffset++] = rxRead();
+                mRxLength = mRxTelegram->getTotalLength();
+                mRxState  = KNX_RX_PAYLOAD;
+                mRxFrameTimeout = mRxLength * mRxByteTime + mTimeoutSlack;
+
+                // the target is known, acknowledge now instead of after the payload
+                // to meet the TP-UART acknowledge deadline even for long telegrams
+                mRxInterested = isAddressed();
+                if (mRxInterested)
+                {
+                    sendAck();
+                }
+                else
+                {
+                    sendNotAddressed();
+                }
+                break;
+
+            case KNX_RX_PAYLOAD:
+            {
+                // take all payload bytes that are already available in one go
+                uint8_t count = mRxLength - 1 - mRxOffset;
+                int avail = rxAvailable();
+                if (avail < count)
+                {
+                    count = avail;
+                }
+                mRxOffset += rxReadBytes(buffer + mRxOffset, count);
+                if (mRxOffset == mRxLength - 1)
+                {
+                    mRxState = KNX_RX_CHECKSUM;
+                }
+                break;
+            }
 
-	uint8_t fullLen = 9 + _tg->getPayloadLength() - 2;
-	while (offs < fullLen)
-	{
-		int read = _serialport->readBytes(_tg->getBuffer() + offs, fullLen - offs);
-		if (read > 0)
-		{
-			offs += read;
-		}
-		else
-		{
-			//timeout
-			// we do a uart reset and return a false
-			uartReset();
-			return TIMEOUT;
-		}
-	}
+            case KNX_RX_CHECKSUM:
+                buffer[mRxOffset++] = rxRead();
+                mRxState = KNX_RX_IDLE;
+                return evaluateKNXTelegram();
+        }
+    }
 
+    return INCOMPLETE_KNX_TELEGRAM;
+}
+
+bool KnxTpUart::isAddressed()
+{
     bool interested = false;
 
+    // the header is decoded in place, only the address fields are received so far
+    KnxFrameView frame(mRxTelegram->getBuffer(), KNX_TELEGRAM_HEADER_SIZE);
+
     // fastest checks first
     // additionally broadcast is the most important one as it's for address assignment
-    if (_tg->isTargetGroup())
+    if (frame.isTargetGroup())
 	{
 		// Broadcast (Programming Mode)
-		interested |= (_listen_to_broadcasts && _tg->getTargetGroupAddress() == 0x0000);
+		interested |= (_listen_to_broadcasts && frame.getTargetGroupAddress() == 0x0000);
 	}
 	else
 	{
 		// Physical address
-		interested |= (_tg->getTargetAddress() == mSourceAddress);
+		interested |= (frame.getTargetAddress() == mSourceAddress);
 	}
 
+    #ifdef KNX_SUPPORT_GROUP_HANDLERS
+        bool listened = false;
+    #endif
+
     if (!interested)
     {
 		if (mTelegramCheckCallback != NULL)
 		{
-			interested |= mTelegramCheckCallback(_tg);
+			interested |= mTelegramCheckCallback(mRxTelegram);
 		}
 
 		#ifdef KNX_SUPPORT_LISTEN_GAS
 			if (!interested)
 			{
 				// Verify if we are interested in this message - GroupAddress
-				interested = _tg->isTargetGroup() && isListeningToGroupAddress(_tg->getTargetGroupAddress());
+				interested = frame.isTargetGroup() && isListeningToGroupAddress(frame.getTargetGroupAddress());
+				#ifdef KNX_SUPPORT_GROUP_HANDLERS
+					listened = interested;
+				#endif
 			}
 		#endif
     }
 
-    if (interested)
-    {
-        sendAck();
-    }
-    else
-    {
-        sendNotAddressed();
-    }
+	#ifdef KNX_SUPPORT_GROUP_HANDLERS
+		// a bound handler implies interest, the entry is kept for dispatching. A listened GA has no handler
+		// unless one was bound to a listened GA, so it costs a single lookup, other GAs a second one.
+		mRxHandler        = NULL;
+		mRxHandlerContext = NULL;
+		if (frame.isTargetGroup() && (!listened || mListenedGroupHandler))
+		{
+			const KnxGroupHandlerEntry* entry = mGroupHandlers.find(frame.getTargetGroupAddress());
+			if (entry != NULL)
+			{
+				mRxHandler        = entry->handler;
+				mRxHandlerContext = entry->context;
+				interested        = true;
+			}
+		}
+	#endif
+
+    return interested;
+}
+
+KnxTpUartSerialEventType KnxTpUart::evaluateKNXTelegram()
+{
+    bool interested = mRxInterested;
 
 	#if defined(TPUART_DEBUG)
 		// Print the received telegram
-		_tg->print(&TPUART_DEBUG_PORT);
+		mRxTelegram->print(&TPUART_DEBUG_PORT);
 	#endif
 
 
-    if (_tg->getCommunicationType() == KNX_COMM_UCD)
+    if (mRxTelegram->getCommunicationType() == KNX_COMM_UCD)
     {
         #if defined(TPUART_DEBUG)
 		    TPUART_DEBUG_PORT.println("UCD Telegram received");
 	    #endif
     }
-    else if (_tg->getCommunicationType() == KNX_COMM_NCD)
+    else if (mRxTelegram->getCommunicationType() == KNX_COMM_NCD)
     {
         #if defined(TPUART_DEBUG)
             TPUART_DEBUG_PORT.print("NCD Telegram ");
-            TPUART_DEBUG_PORT.print(_tg->getSequenceNumber());
+            TPUART_DEBUG_PORT.print(mRxTelegram->getSequenceNumber());
             TPUART_DEBUG_PORT.println(" received");
         #endif
-        if (interested)
-        {
-            // Thanks to Katja Blankenheim for the help
-            sendNCDPosConfirm(_tg->getSequenceNumber(), _tg->getSourceAddress());
-        }
     }
 
+    // the positive confirmation of a NCD telegram is sent when the telegram is handed out,
+    // so the receiver is never entered again while it is evaluating a telegram
+    mRxSlotInterested[mRxSlot] = interested;
+    #ifdef KNX_SUPPORT_GROUP_HANDLERS
+        mRxSlotHandler[mRxSlot]        = mRxHandler;
+        mRxSlotHandlerContext[mRxSlot] = mRxHandlerContext;
+    #endif
+    queueReceivedTelegram();
+
     // Returns if we are interested in this diagram
     return interested ? KNX_TELEGRAM : IRRELEVANT_KNX_TELEGRAM;
 }
 
 KnxTelegram* KnxTpUart::getReceivedTelegram()
 {
-    return _tg;
+    return &mRxSlots[mRxDelivered];
+}
+
+KnxFrameView KnxTpUart::getReceivedFrame()
+{
+    KnxTelegram* telegram = &mRxSlots[mRxDelivered];
+    return KnxFrameView(telegram->getBuffer(), telegram->getTotalLength());
 }
 
 // Command Write
@@ -326,8 +738,7 @@ bool KnxTpUart::groupWriteBool(String aAddress, bool aValue)
 
 bool KnxTpUart::groupWriteBool(uint16_t aAddress, bool aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, (aValue) ? 0x01 : 0x00);
-    return sendMessage();
+    return groupWrite<KnxDpt1>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite4BitInt(String aAddress, uint8_t aValue)
@@ -337,8 +748,7 @@ bool KnxTpUart::groupWrite4BitInt(String aAddress, uint8_t aValue)
 
 bool KnxTpUart::groupWrite4BitInt(uint16_t aAddress, uint8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, (aValue & B00001111));
-    return sendMessage();
+    return groupWrite<KnxDpt3>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite4BitDim(String aAddress, bool aDirection, uint8_t aSteps)
@@ -348,8 +758,7 @@ bool KnxTpUart::groupWrite4BitDim(String aAddress, bool aDirection, uint8_t aSte
 
 bool KnxTpUart::groupWrite4BitDim(uint16_t aAddress, bool aDirection, uint8_t aSteps)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, ((aDirection & 0x01) << 3) | (aSteps & B00000111));
-    return sendMessage();
+    return groupWrite<KnxDpt3>(aAddress, ((aDirection & 0x01) << 3) | (aSteps & B00000111));
 }
 
 
@@ -360,10 +769,7 @@ bool KnxTpUart::groupWrite1ByteInt(String aAddress, int8_t aValue)
 
 bool KnxTpUart::groupWrite1ByteInt(uint16_t aAddress, int8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set1ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt6>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite1ByteUInt(String aAddress, uint8_t aValue)
@@ -373,10 +779,7 @@ bool KnxTpUart::groupWrite1ByteUInt(String aAddress, uint8_t aValue)
 
 bool KnxTpUart::groupWrite1ByteUInt(uint16_t aAddress, uint8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set1ByteUIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt5>(aAddress, aValue);
 }
 
 
@@ -387,18 +790,12 @@ bool KnxTpUart::groupWrite2ByteInt(String aAddress, int16_t aValue)
 
 bool KnxTpUart::groupWrite2ByteInt(uint16_t aAddress, int16_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set2ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt8>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite2ByteUInt(uint16_t aAddress, uint16_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set2ByteUIntValue(aValue);
-    _tg->createChecksum();
-  	return sendMessage();
+    return groupWrite<KnxDpt7>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite2ByteUInt(String aAddress, uint16_t aValue)
@@ -408,18 +805,12 @@ bool KnxTpUart::groupWrite2ByteUInt(String aAddress, uint16_t aValue)
 
 bool KnxTpUart::groupWrite4ByteInt(uint16_t aAddress, int32_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set4ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt13>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite4ByteUInt(uint16_t aAddress, uint32_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set4ByteUIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt12>(aAddress, aValue);
 }
 
 
@@ -430,10 +821,7 @@ bool KnxTpUart::groupWrite2ByteFloat(String aAddress, float aValue)
 
 bool KnxTpUart::groupWrite2ByteFloat(uint16_t aAddress, float aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set2ByteFloatValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt9>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite3ByteTime(String aAddress, uint8_t aWeekday, uint8_t aHour, uint8_t aMinute, uint8_t aSecond)
@@ -443,10 +831,8 @@ bool KnxTpUart::groupWrite3ByteTime(String aAddress, uint8_t aWeekday, uint8_t a
 
 bool KnxTpUart::groupWrite3ByteTime(uint16_t aAddress, uint8_t aWeekday, uint8_t aHour, uint8_t aMinute, uint8_t aSecond)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set3ByteTime(aWeekday, aHour, aMinute, aSecond);
-    _tg->createChecksum();
-    return sendMessage();
+    KnxTime time = { aWeekday, aHour, aMinute, aSecond };
+    return groupWrite<KnxDpt10>(aAddress, time);
 }
 
 
@@ -457,10 +843,8 @@ bool KnxTpUart::groupWrite3ByteDate(String aAddress, uint8_t aDay, uint8_t aMont
 
 bool KnxTpUart::groupWrite3ByteDate(uint16_t aAddress, uint8_t aDay, uint8_t aMonth, uint8_t aYear)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set3ByteDate(aDay, aMonth, aYear);
-    _tg->createChecksum();
-    return sendMessage();
+    KnxDate date = { aDay, aMonth, aYear };
+    return groupWrite<KnxDpt11>(aAddress, date);
 }
 
 bool KnxTpUart::groupWrite4ByteFloat(String aAddress, float aValue)
@@ -470,10 +854,7 @@ bool KnxTpUart::groupWrite4ByteFloat(String aAddress, float aValue)
 
 bool KnxTpUart::groupWrite4ByteFloat(uint16_t aAddress, float aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set4ByteFloatValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt14>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupWrite14ByteText(String aAddress, String aValue)
@@ -483,10 +864,7 @@ bool KnxTpUart::groupWrite14ByteText(String aAddress, String aValue)
 
 bool KnxTpUart::groupWrite14ByteText(uint16_t aAddress, String aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
-    _tg->set14ByteValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupWrite<KnxDpt16>(aAddress, aValue.c_str());
 }
 
 bool KnxTpUart::groupWriteBuffer(uint16_t aAddress, uint8_t* aBuffer, uint8_t aSize)
@@ -497,7 +875,6 @@ bool KnxTpUart::groupWriteBuffer(uint16_t aAddress, uint8_t* aBuffer, uint8_t aS
 	}
     createKNXMessageFrame(2, KNX_COMMAND_WRITE, aAddress, 0);
     _tg->setValue(aBuffer, aSize);
-    _tg->createChecksum();
     return sendMessage();
 }
 
@@ -510,8 +887,7 @@ bool KnxTpUart::groupAnswerBool(String aAddress, bool aValue)
 
 bool KnxTpUart::groupAnswerBool(uint16_t aAddress, bool aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, aValue ? 0x01 : 0x00);
-    return sendMessage();
+    return groupAnswer<KnxDpt1>(aAddress, aValue);
 }
 
 
@@ -522,8 +898,7 @@ bool KnxTpUart::groupAnswer4BitInt(String aAddress, uint8_t aValue)
 
 bool KnxTpUart::groupAnswer4BitInt(uint16_t aAddress, uint8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, (aValue & B00001111));
-    return sendMessage();
+    return groupAnswer<KnxDpt3>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer4BitDim(String aAddress, bool aDirection, uint8_t aSteps)
@@ -533,8 +908,7 @@ bool KnxTpUart::groupAnswer4BitDim(String aAddress, bool aDirection, uint8_t aSt
 
 bool KnxTpUart::groupAnswer4BitDim(uint16_t aAddress, bool aDirection, uint8_t aSteps)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, ((aDirection & 0x01) << 3) | (aSteps & B00000111));
-    return sendMessage();
+    return groupAnswer<KnxDpt3>(aAddress, ((aDirection & 0x01) << 3) | (aSteps & B00000111));
 }
 
 bool KnxTpUart::groupAnswer1ByteInt(String aAddress, int8_t aValue)
@@ -544,10 +918,7 @@ bool KnxTpUart::groupAnswer1ByteInt(String aAddress, int8_t aValue)
 
 bool KnxTpUart::groupAnswer1ByteInt(uint16_t aAddress, int8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set1ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt6>(aAddress, aValue);
 }
 
 
@@ -558,10 +929,7 @@ bool KnxTpUart::groupAnswer1ByteUInt(String aAddress, uint8_t aValue)
 
 bool KnxTpUart::groupAnswer1ByteUInt(uint16_t aAddress, uint8_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set1ByteUIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt5>(aAddress, aValue);
 }
 
 
@@ -572,10 +940,7 @@ bool KnxTpUart::groupAnswer2ByteInt(String aAddress, int16_t aValue)
 
 bool KnxTpUart::groupAnswer2ByteInt(uint16_t aAddress, int16_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set2ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt8>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer2ByteUInt(String aAddress, uint16_t aValue)
@@ -585,26 +950,17 @@ bool KnxTpUart::groupAnswer2ByteUInt(String aAddress, uint16_t aValue)
 
 bool KnxTpUart::groupAnswer2ByteUInt(uint16_t aAddress, uint16_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set2ByteUIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt7>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer4ByteInt(uint16_t aAddress, int32_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set4ByteIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt13>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer4ByteUInt(uint16_t aAddress, uint32_t aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set4ByteUIntValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt12>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer2ByteFloat(String aAddress, float aValue)
@@ -614,10 +970,7 @@ bool KnxTpUart::groupAnswer2ByteFloat(String aAddress, float aValue)
 
 bool KnxTpUart::groupAnswer2ByteFloat(uint16_t aAddress, float aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set2ByteFloatValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt9>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer3ByteTime(String aAddress, uint8_t aWeekday, uint8_t aHour, uint8_t aMinute, uint8_t sSecond)
@@ -627,10 +980,8 @@ bool KnxTpUart::groupAnswer3ByteTime(String aAddress, uint8_t aWeekday, uint8_t
 
 bool KnxTpUart::groupAnswer3ByteTime(uint16_t aAddress, uint8_t aWeekday, uint8_t aHour, uint8_t aMinute, uint8_t sSecond)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set3ByteTime(aWeekday, aHour, aMinute, sSecond);
-    _tg->createChecksum();
-    return sendMessage();
+    KnxTime time = { aWeekday, aHour, aMinute, sSecond };
+    return groupAnswer<KnxDpt10>(aAddress, time);
 }
 
 bool KnxTpUart::groupAnswer3ByteDate(String aAddress, uint8_t aDay, uint8_t aMonth, uint8_t aYear)
@@ -640,10 +991,8 @@ bool KnxTpUart::groupAnswer3ByteDate(String aAddress, uint8_t aDay, uint8_t aMon
 
 bool KnxTpUart::groupAnswer3ByteDate(uint16_t aAddress, uint8_t aDay, uint8_t aMonth, uint8_t aYear)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set3ByteDate(aDay, aMonth, aYear);
-    _tg->createChecksum();
-    return sendMessage();
+    KnxDate date = { aDay, aMonth, aYear };
+    return groupAnswer<KnxDpt11>(aAddress, date);
 }
 
 
@@ -654,10 +1003,7 @@ bool KnxTpUart::groupAnswer4ByteFloat(String aAddress, float aValue)
 
 bool KnxTpUart::groupAnswer4ByteFloat(uint16_t aAddress, float aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set4ByteFloatValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt14>(aAddress, aValue);
 }
 
 bool KnxTpUart::groupAnswer14ByteText(String aAddress, String aValue)
@@ -667,10 +1013,7 @@ bool KnxTpUart::groupAnswer14ByteText(String aAddress, String aValue)
 
 bool KnxTpUart::groupAnswer14ByteText(uint16_t aAddress, String aValue)
 {
-    createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
-    _tg->set14ByteValue(aValue);
-    _tg->createChecksum();
-    return sendMessage();
+    return groupAnswer<KnxDpt16>(aAddress, aValue.c_str());
 }
 
 
@@ -682,7 +1025,6 @@ bool KnxTpUart::groupAnswerBuffer(uint16_t aAddress, uint8_t* aBuffer, uint8_t a
 	}
     createKNXMessageFrame(2, KNX_COMMAND_ANSWER, aAddress, 0);
     _tg->setValue(aBuffer, aSize);
-    _tg->createChecksum();
     return sendMessage();
 }
 
@@ -695,13 +1037,11 @@ bool KnxTpUart::groupRead(String aAddress)
 
 bool KnxTpUart::groupRead(uint16_t aAddress) {
     createKNXMessageFrame(2, KNX_COMMAND_READ, aAddress, 0);
-    _tg->createChecksum();
     return sendMessage();
 }
 
 bool KnxTpUart::individualAnswerAddress() {
     createKNXMessageFrame(2, KNX_COMMAND_INDIVIDUAL_ADDR_RESPONSE, 0x0000, 0);
-    _tg->createChecksum();
     return sendMessage();
 }
 
@@ -716,7 +1056,6 @@ bool KnxTpUart::individualAnswerMaskVersion(uint16_t aAddress)
     _tg->setCommunicationType(KNX_COMM_NDP);
     _tg->setBufferByte(8, 0x07); // Mask version part 1 for BIM M 112
     _tg->setBufferByte(9, 0x01); // Mask version part 2 for BIM M 112
-    _tg->createChecksum();
     return sendMessage();
 }
 
@@ -731,7 +1070,6 @@ bool KnxTpUart::individualAnswerAuth(uint8_t accessLevel, uint8_t sequenceNo, ui
     _tg->setCommunicationType(KNX_COMM_NDP);
     _tg->setSequenceNumber(sequenceNo);
     _tg->setBufferByte(8, accessLevel);
-    _tg->createChecksum();
     return sendMessage();
 }
 
@@ -743,13 +1081,8 @@ void KnxTpUart::createKNXMessageFrame(uint8_t payloadlength, KnxCommandType comm
 
 void KnxTpUart::createKNXMessageFrame(uint8_t payloadlength, KnxCommandType command, uint16_t aAddress, uint8_t firstDataByte)
 {
-    _tg->clear();
-    _tg->setSourceAddress(mSourceAddress);
-    _tg->setTargetGroupAddress(aAddress);
-    _tg->setFirstDataByte(firstDataByte);
-    _tg->setCommand(command);
+    buildGroupTelegram(_tg, command, aAddress, firstDataByte);
     _tg->setPayloadLength(payloadlength);
-    _tg->createChecksum();
 }
 
 
@@ -761,13 +1094,26 @@ void KnxTpUart::createKNXMessageFrameIndividual(uint8_t payloadlength, KnxComman
 
 void KnxTpUart::createKNXMessageFrameIndividual(uint8_t payloadlength, KnxCommandType command, uint16_t aAddress, uint8_t firstDataByte)
 {
-    _tg->clear();
-    _tg->setSourceAddress(mSourceAddress);
-    _tg->setTargetIndividualAddress(aAddress);
-    _tg->setFirstDataByte(firstDataByte);
-    _tg->setCommand(command);
+    buildIndividualTelegram(_tg, command, aAddress, firstDataByte);
     _tg->setPayloadLength(payloadlength);
-    _tg->createChecksum();
+}
+
+void KnxTpUart::buildGroupTelegram(KnxTelegram* aTelegram, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte)
+{
+    aTelegram->clear();
+    aTelegram->setSourceAddress(mSourceAddress);
+    aTelegram->setTargetGroupAddress(aAddress);
+    aTelegram->setFirstDataByte(aFirstDataByte);
+    aTelegram->setCommand(aCommand);
+}
+
+void KnxTpUart::buildIndividualTelegram(KnxTelegram* aTelegram, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte)
+{
+    aTelegram->clear();
+    aTelegram->setSourceAddress(mSourceAddress);
+    aTelegram->setTargetIndividualAddress(aAddress);
+    aTelegram->setFirstDataByte(aFirstDataByte);
+    aTelegram->setCommand(aCommand);
 }
 
 
@@ -783,110 +1129,476 @@ bool KnxTpUart::sendNCDPosConfirm(uint8_t sequenceNo, uint16_t aAddress)
     _tg_ptp.setPayloadLength(1);
     _tg_ptp.createChecksum();
 
+    // called from serialEvent(), which must not block
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        if (mTxCount >= KNX_TX_QUEUE_SIZE)
+        {
+            #if defined(TPUART_DEBUG)
+                TPUART_DEBUG_PORT.println("Send queue full, NCD confirm dropped");
+            #endif
+            return false;
+        }
+        insertQueuedTelegram(&_tg_ptp, NULL, NULL, true);
+    #else
+        writeTelegram(_tg_ptp.getBuffer(), _tg_ptp.getTotalLength(), false);
+        consumeSendCredit(_tg_ptp.getTotalLength());
+        mTxUnconfirmed++;
+    #endif
+    return true;
+}
+
+bool KnxTpUart::sendMessage()
+{
+    // the helpers only set header and value, the checksum is calculated once here
+    _tg->createChecksum();
 
-    uint8_t messageSize = _tg_ptp.getTotalLength();
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        if (mTxQueuedSend)
+        {
+            return queueTelegram(_tg);
+        }
+    #endif
+    return sendTelegram(_tg);
+}
 
-    uint8_t sendbuf[2];
-    for (uint8_t i = 0; i < messageSize; i++)
+bool KnxTpUart::sendTelegram(KnxTelegram* aTelegram)
+{
+    if (!passSendFilter(aTelegram))
     {
-        if (i == (messageSize - 1))
+        // the bus already knows the value
+        return true;
+    }
+
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        // keep the TP-UART confirmations in order
+        flushSendQueue();
+    #endif
+
+    bool res = transmitTelegram(aTelegram->getBuffer(), aTelegram->getTotalLength());
+
+    #ifdef KNX_SUPPORT_SEND_FILTER
+        if (!res && aTelegram->isTargetGroup())
         {
-            sendbuf[0] = TPUART_DATA_END;
+            // not on the bus, so the next write must not be suppressed
+            mSendFilter.invalidate(aTelegram->getTargetGroupAddress());
         }
-        else
+    #endif
+    return res;
+}
+
+bool KnxTpUart::sendTelegram(const uint8_t* aBuffer, uint8_t aLength)
+{
+    if (aLength != KNX_TELEGRAM_HEADER_SIZE + (aBuffer[5] & B00001111) + 2)
+    {
+        // the length field in the header does not match the buffer
+        return false;
+    }
+
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        flushSendQueue();
+    #endif
+
+    return transmitTelegram(aBuffer, aLength);
+}
+
+bool KnxTpUart::sendTemplate(KnxTelegramTemplate* aTemplate)
+{
+    if (aTemplate->getFrameLength() == 0)
+    {
+        return false;
+    }
+
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        flushSendQueue();
+    #endif
+
+    return transmitFrame(aTemplate->getFrame(), aTemplate->getFrameLength());
+}
+
+bool KnxTpUart::passSendFilter(KnxTelegram* aTelegram)
+{
+    #ifdef KNX_SUPPORT_SEND_FILTER
+        if (!mSendFilter.pass(aTelegram, mClock->getMillis()))
         {
-            sendbuf[0] = TPUART_DATA_START_CONTINUE;
+            mTxStatistics.suppressed++;
+            return false;
         }
+    #endif
+    return true;
+}
 
-        sendbuf[0] |= i;
-        sendbuf[1] = _tg_ptp.getBufferByte(i);
+uint8_t KnxTpUart::encodeTelegram(KnxTelegram* aTelegram, uint8_t* aFrame)
+{
+    return encodeTelegram(aTelegram->getBuffer(), aTelegram->getTotalLength(), aFrame);
+}
 
-        _serialport->write(sendbuf, 2);
+uint8_t KnxTpUart::encodeTelegram(const uint8_t* aBuffer, uint8_t aLength, uint8_t* aFrame)
+{
+    for (uint8_t i = 0; i < aLength; i++)
+    {
+        aFrame[2 * i]     = TPUART_DATA_START_CONTINUE | i;
+        aFrame[2 * i + 1] = aBuffer[i];
     }
+    aFrame[2 * (aLength - 1)] = TPUART_DATA_END | (aLength - 1);
+
+    return 2 * aLength;
+}
+
+void KnxTpUart::writeTelegram(const uint8_t* aBuffer, uint8_t aLength, bool aRepeated)
+{
+    uint8_t frame[TPUART_FRAME_MAX_SIZE];
+    writeFrame(frame, encodeTelegram(aBuffer, aLength, frame), aRepeated);
+}
 
+void KnxTpUart::writeFrame(uint8_t* aFrame, uint8_t aLength, bool aRepeated)
+{
+    // the repeat flag is set by clearing bit 5 of the control field (see KnxTelegram::setRepeated()),
+    // the checksum byte changes the same bit, both are restored after writing
+    uint8_t repeat = (aRepeated ? aFrame[1] : 0) & B00100000;
+    aFrame[1]           ^= repeat;
+    aFrame[aLength - 1] ^= repeat;
+    _serialport->write(aFrame, aLength);
+    aFrame[1]           ^= repeat;
+    aFrame[aLength - 1] ^= repeat;
+}
 
-    int confirmation;
+bool KnxTpUart::transmitTelegram(const uint8_t* aBuffer, uint8_t aLength)
+{
+    uint8_t frame[TPUART_FRAME_MAX_SIZE];
+    return transmitFrame(frame, encodeTelegram(aBuffer, aLength, frame));
+}
+
+bool KnxTpUart::transmitFrame(uint8_t* aFrame, uint8_t aLength)
+{
+    uint8_t attempts = 0;
+    unsigned long backoff = 0;
     while (true)
     {
-        confirmation = serialRead();
+        waitBeforeSending(backoff);
+        writeFrame(aFrame, aLength, attempts > 0);
+        consumeSendCredit(aLength / 2);
+        attempts++;
+
+        // TPUART_SEND_NOT_SUCCESS or timeout (-1) fail
+        int confirmation = waitForConfirmation(aLength / 2);
         if (confirmation == TPUART_SEND_SUCCESS)
         {
-            return true; // Sent successfully
+            countSentTelegram(attempts, true);
+            return true;
         }
-        else if (confirmation == TPUART_SEND_NOT_SUCCESS)
+        if (confirmation == TPUART_RESET_INDICATION_BYTE)
         {
+            // the TP-UART reset itself and dropped the telegram, it is up to the sketch to react
+            countSentTelegram(attempts, false);
             return false;
         }
-        else if (confirmation == -1)
+        if (confirmation < 0)
+        {
+            // the TP-UART may still hold the telegram, resync before it is written again
+            uartReset();
+        }
+        if (attempts >= mTxMaxAttempts)
         {
-            // Read timeout
+            countSentTelegram(attempts, false);
             return false;
         }
+
+        #if defined(TPUART_DEBUG)
+            TPUART_DEBUG_PORT.println("Send failed, retransmitting");
+        #endif
+        backoff = getRetryBackoff(attempts);
     }
+}
 
-    return false;
+void KnxTpUart::setSendRetries(uint8_t aMaxAttempts, uint16_t aBackoffMs)
+{
+    if (aMaxAttempts < 1)
+    {
+        aMaxAttempts = 1;
+    }
+    else if (aMaxAttempts > KNX_TX_MAX_ATTEMPTS)
+    {
+        aMaxAttempts = KNX_TX_MAX_ATTEMPTS;
+    }
+    mTxMaxAttempts  = aMaxAttempts;
+    mTxRetryBackoff = aBackoffMs;
 }
 
-bool KnxTpUart::sendMessage()
+unsigned long KnxTpUart::getRetryBackoff(uint8_t aAttempts)
 {
-    return sendTelegram(_tg);
+    return (unsigned long)mTxRetryBackoff << (aAttempts - 1);
 }
 
-bool KnxTpUart::sendTelegram(KnxTelegram* aTelegram)
+void KnxTpUart::setBusLoadLimit(uint8_t aTelegramsPerSecond, uint8_t aLoadPercent)
+{
+    mTxRateLimit = aTelegramsPerSecond;
+    mTxLoadLimit = aLoadPercent;
+}
+
+unsigned long KnxTpUart::getBusTime(uint8_t aTotalLength)
+{
+    unsigned long bits = 50 + 13UL * aTotalLength + 15 + 11;
+    return (bits * 1000000UL) / KNX_BUS_BAUDRATE;
+}
+
+void KnxTpUart::setTimeouts(unsigned long aHostBaudrate, unsigned long aSlackUs)
+{
+    // 11 bit per byte on the host link (8E1), 13 bit per character on the bus, rounded up
+    mHostByteTime = (11000000UL + aHostBaudrate - 1) / aHostBaudrate;
+    unsigned long busByteTime = (13000000UL + KNX_BUS_BAUDRATE - 1) / KNX_BUS_BAUDRATE;
+    mRxByteTime   = (mHostByteTime > busByteTime) ? mHostByteTime : busByteTime;
+    mTimeoutSlack = aSlackUs;
+}
+
+unsigned long KnxTpUart::getByteTimeout()
 {
-    uint8_t messageSize = aTelegram->getTotalLength();
+    return mRxByteTime + mTimeoutSlack;
+}
+
+unsigned long KnxTpUart::getConfirmTimeout(uint8_t aTotalLength)
+{
+    // the frame (control and data byte per telegram byte) to the TP-UART, the telegram on the bus
+    // and the up to 3 repetitions of the TP-UART if nobody acknowledged it, then the confirmation
+    return (2UL * aTotalLength + 1) * mHostByteTime + 4 * getBusTime(aTotalLength) + mTimeoutSlack;
+}
+
+bool KnxTpUart::hasSendCredit()
+{
+    if (mTxRateLimit == 0 && mTxLoadLimit == 0)
+    {
+        return true;
+    }
 
-    uint8_t sendbuf[2];
-    for (int i = 0; i < messageSize; i++)
+    unsigned long now     = mClock->getMicros();
+    unsigned long elapsed = now - mTxCreditTime;
+    mTxCreditTime = now;
+
+    const long capacity = KNX_TX_BURST_MS * 1000L;
+    if (elapsed >= (unsigned long)(capacity - mTxCredit))
     {
-        if (i == (messageSize - 1))
+        mTxCredit = capacity;
+    }
+    else
+    {
+        mTxCredit += elapsed;
+    }
+
+    // a telegram may be written as long as no credit is owed, its cost is charged afterwards
+    return mTxCredit >= 0;
+}
+
+void KnxTpUart::consumeSendCredit(uint8_t aLength)
+{
+    unsigned long cost = 0;
+    if (mTxRateLimit > 0)
+    {
+        cost = 1000000UL / mTxRateLimit;
+    }
+    if (mTxLoadLimit > 0)
+    {
+        unsigned long busy = getBusTime(aLength) * 100 / mTxLoadLimit;
+        if (busy > cost)
         {
-            sendbuf[0] = TPUART_DATA_END;
+            cost = busy;
         }
-        else
+    }
+    mTxCredit -= cost;
+}
+
+const KnxTpUartSendStatistics* KnxTpUart::getSendStatistics()
+{
+    return &mTxStatistics;
+}
+
+void KnxTpUart::resetSendStatistics()
+{
+    memset(&mTxStatistics, 0, sizeof(mTxStatistics));
+}
+
+void KnxTpUart::countSentTelegram(uint8_t aAttempts, bool aConfirmed)
+{
+    mTxStatistics.telegrams++;
+    mTxStatistics.attempts += aAttempts;
+    if (aConfirmed)
+    {
+        mTxStatistics.confirmedAfter[aAttempts - 1]++;
+    }
+    else
+    {
+        mTxStatistics.failed++;
+    }
+}
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+
+/**
+ * @return the sending order of a priority, system first, normal last.
+ */
+static uint8_t txPriorityRank(KnxPriorityType aPriority)
+{
+    switch (aPriority)
+    {
+        case KNX_PRIORITY_SYSTEM:
+            return 0;
+        case KNX_PRIORITY_ALARM:
+            return 1;
+        case KNX_PRIORITY_HIGH:
+            return 2;
+        default:
+            return 3;
+    }
+}
+
+bool KnxTpUart::queueTelegram(KnxTelegram* aTelegram, KnxSendCallbackType aCallback, void* aContext)
+{
+    if (mTxCount >= KNX_TX_QUEUE_SIZE)
+    {
+        #if defined(TPUART_DEBUG)
+            TPUART_DEBUG_PORT.println("Send queue full");
+        #endif
+        return false;
+    }
+
+    if (!passSendFilter(aTelegram))
+    {
+        if (aCallback != NULL)
         {
-            sendbuf[0] = TPUART_DATA_START_CONTINUE;
+            aCallback(aTelegram, KNX_SEND_SUPPRESSED, aContext);
         }
+        return true;
+    }
 
-        sendbuf[0] |= i;
-        sendbuf[1] = aTelegram->getBufferByte(i);
+    insertQueuedTelegram(aTelegram, aCallback, aContext, false);
+    return true;
+}
 
-        _serialport->write(sendbuf, 2);
+void KnxTpUart::insertQueuedTelegram(KnxTelegram* aTelegram, KnxSendCallbackType aCallback, void* aContext, bool aFirst)
+{
+    uint8_t slot = 0;
+    while (mTxSlotUsed[slot])
+    {
+        slot++;
     }
+    mTxSlots[slot]    = *aTelegram;
+    mTxCallback[slot] = aCallback;
+    mTxContext[slot]  = aContext;
+    mTxSlotUsed[slot] = true;
+    mTxAttempts[slot] = 0;
+
+    // insert behind all telegrams of the same or a higher priority (or in front of all), the active one is never passed
+    uint8_t rank  = txPriorityRank(aTelegram->getPriority());
+    uint8_t first = mTxActive ? 1 : 0;
+    uint8_t pos   = mTxCount;
+    while (pos > first && (aFirst || txPriorityRank(mTxSlots[mTxOrder[pos - 1]].getPriority()) > rank))
+    {
+        mTxOrder[pos] = mTxOrder[pos - 1];
+        pos--;
+    }
+    mTxOrder[pos] = slot;
+    mTxCount++;
 
+    serviceSendQueue();
+}
 
-    int confirmation;
-    bool res;
-    while (true)
+void KnxTpUart::setQueuedSend(bool aQueued)
+{
+    mTxQueuedSend = aQueued;
+}
+
+uint8_t KnxTpUart::getSendQueueCount()
+{
+    return mTxCount;
+}
+
+void KnxTpUart::serviceSendQueue()
+{
+    if (mTxActive)
     {
-        confirmation = serialRead();
-        if (confirmation == TPUART_SEND_SUCCESS)
+        // as for a blocking send the deadline starts again with every byte received, the TP-UART
+        // cannot send while the bus is busy with other telegrams
+        unsigned long now  = mClock->getMicros();
+        unsigned long idle = now - mTxStartTime;
+        if ((now - mRxLastByteTime) < idle)
         {
-        	// Sent successfully
-            res = true;
-            break;
+            idle = now - mRxLastByteTime;
         }
-        else if (confirmation == TPUART_SEND_NOT_SUCCESS)
+        if (idle > getConfirmTimeout(mTxSlots[mTxOrder[0]].getTotalLength()))
         {
-        	// Sent unsuccessfully
-            res = false;
-            break;
+            #if defined(TPUART_DEBUG)
+                TPUART_DEBUG_PORT.println("Send confirmation timeout");
+            #endif
+            // the TP-UART may still hold the telegram, a late confirmation must not complete the next one
+            uartReset();
+            completeQueuedTelegram(KNX_SEND_TIMEOUT);
         }
-        else if (confirmation == -1)
+    }
+    else if (mTxCount > 0 && !mSendPending && (mClock->getMillis() - mTxRetryTime) >= mTxRetryDelay && hasSendCredit())
+    {
+        // a blocking send waiting for its confirmation goes first
+        uint8_t slot = mTxOrder[0];
+        uint8_t length = mTxSlots[slot].getTotalLength();
+        writeTelegram(mTxSlots[slot].getBuffer(), length, mTxAttempts[slot] > 0);
+        consumeSendCredit(length);
+        mTxAttempts[slot]++;
+        mTxActive    = true;
+        mTxStartTime = mClock->getMicros();
+    }
+}
+
+void KnxTpUart::completeQueuedTelegram(KnxTpUartSendResultType aResult)
+{
+    uint8_t slot = mTxOrder[0];
+
+    if (aResult != KNX_SEND_CONFIRMED && mTxAttempts[slot] < mTxMaxAttempts)
+    {
+        // keep it first in the queue, serviceSendQueue() writes it again once the backoff elapsed
+        #if defined(TPUART_DEBUG)
+            TPUART_DEBUG_PORT.println("Send failed, retransmitting");
+        #endif
+        mTxActive     = false;
+        mTxRetryTime  = mClock->getMillis();
+        mTxRetryDelay = getRetryBackoff(mTxAttempts[slot]);
+        return;
+    }
+    countSentTelegram(mTxAttempts[slot], aResult == KNX_SEND_CONFIRMED);
+
+    #ifdef KNX_SUPPORT_SEND_FILTER
+        if (aResult != KNX_SEND_CONFIRMED && mTxSlots[slot].isTargetGroup())
         {
-            // Read timeout
-            res = false;
-            break;
+            mSendFilter.invalidate(mTxSlots[slot].getTargetGroupAddress());
         }
+    #endif
+
+    // the entry stays active during the callback, telegrams queued by the callback go behind it
+    if (mTxCallback[slot] != NULL)
+    {
+        mTxCallback[slot](&mTxSlots[slot], aResult, mTxContext[slot]);
     }
 
-#if defined(SERIAL_WRITE_DELAY_MS)
-    //TODO: change to wait on next if needed but do not always delay
-    delay(SERIAL_WRITE_DELAY_MS);
-#endif
-    return res;
+    for (uint8_t i = 1; i < mTxCount; i++)
+    {
+        mTxOrder[i - 1] = mTxOrder[i];
+    }
+    mTxCount--;
+    mTxSlotUsed[slot] = false;
+    mTxActive         = false;
+
+    serviceSendQueue();
 }
 
+void KnxTpUart::flushSendQueue()
+{
+    mSendWaiting = true;
+    while (mTxCount > 0)
+    {
+        receive();
+        serviceSendQueue();
+    }
+    mSendWaiting = false;
+}
+
+#endif
+
 
 void KnxTpUart::sendAck()
 {
@@ -901,53 +1613,93 @@ void KnxTpUart::sendNotAddressed()
     _serialport->write(sendByte);
 }
 
-int KnxTpUart::serialRead() {
-  unsigned long startTime = millis();
-#if defined(TPUART_DEBUG)
-  TPUART_DEBUG_PORT.print("Available: ");
-  TPUART_DEBUG_PORT.println(_serialport->available());
-#endif
+int KnxTpUart::waitForConfirmation(uint8_t aTotalLength)
+{
+    // telegrams arriving meanwhile are received, acknowledged and queued as usual
+    mSendPending      = true;
+    mSendWaiting      = true;
+    mSendConfirmation = -1;
 
-  while (! (_serialport->available() > 0)) {
-    if (abs(millis() - startTime) > SERIAL_READ_TIMEOUT_MS) {
-      // Timeout
-#if defined(TPUART_DEBUG)
-      TPUART_DEBUG_PORT.println("Timeout while receiving message");
-#endif
-      return -1;
+    const unsigned long timeout = getConfirmTimeout(aTotalLength);
+    unsigned long lastByteTime = mClock->getMicros();
+    while (mSendConfirmation < 0)
+    {
+        if (rxAvailable() > 0)
+        {
+            lastByteTime = mClock->getMicros();
+            receive();
+            continue;
+        }
+
+        unsigned long idle = mClock->getMicros() - lastByteTime;
+        if (idle > timeout)
+        {
+            #if defined(TPUART_DEBUG)
+                TPUART_DEBUG_PORT.println("Timeout while waiting for confirmation");
+            #endif
+            break;
+        }
+        // one past the timeout, so the wait may end exactly when it expired
+        mClock->wait(timeout - idle + 1);
     }
-    delay(1);
-  }
 
-  int inByte = _serialport->read();
-  checkErrors();
-  printByte(inByte);
+    mSendPending = false;
+    mSendWaiting = false;
+    return mSendConfirmation;
+}
+
+void KnxTpUart::waitBeforeSending(unsigned long aDelayMs)
+{
+    mSendWaiting = true;
 
-  return inByte;
+    const unsigned long delayUs = aDelayMs * 1000UL;
+    unsigned long start = mClock->getMicros();
+    unsigned long elapsed = 0;
+    while (elapsed < delayUs || !hasSendCredit())
+    {
+        if (rxAvailable() > 0)
+        {
+            receive();
+        }
+        else if (elapsed < delayUs)
+        {
+            mClock->wait(delayUs - elapsed);
+        }
+        else
+        {
+            // the governor owes credit, it is paid back one microsecond per microsecond
+            mClock->wait((unsigned long)-mTxCredit);
+        }
+        elapsed = mClock->getMicros() - start;
+    }
+
+    mSendWaiting = false;
 }
 
 
-uint16_t KnxTpUart::getGroupAddress(String aAddress)
+uint16_t KnxTpUart::getGroupAddress(const char* aAddress)
+{
+    uint16_t addr = 0;
+    KnxAddress::parseGroupAddress(aAddress, &addr);
+    return addr;
+}
+
+uint16_t KnxTpUart::getGroupAddress(const String& aAddress)
 {
-	const char aDelimiter = '/';
-	uint16_t addr = aAddress.substring(0, aAddress.indexOf(aDelimiter)).toInt();
-	addr = addr << 5;
-	addr |= aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).substring(0, aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).indexOf(aDelimiter)).toInt();
-	addr = addr << 3;
-	addr |= aAddress.substring(aAddress.lastIndexOf(aDelimiter) + 1, aAddress.length()).toInt();
-	return addr;
+    return getGroupAddress(aAddress.c_str());
 }
 
 
-uint16_t KnxTpUart::getSourceAddress(String aAddress)
+uint16_t KnxTpUart::getSourceAddress(const char* aAddress)
 {
-	const char aDelimiter = '.';
-	uint16_t addr = aAddress.substring(0, aAddress.indexOf(aDelimiter)).toInt();
-	addr = addr << 4;
-	addr |= aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).substring(0, aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).indexOf(aDelimiter)).toInt();
-	addr = addr << 4;
-	addr |= aAddress.substring(aAddress.lastIndexOf(aDelimiter) + 1, aAddress.length()).toInt();
-	return addr;
+    uint16_t addr = 0;
+    KnxAddress::parseIndividualAddress(aAddress, &addr);
+    return addr;
+}
+
+uint16_t KnxTpUart::getSourceAddress(const String& aAddress)
+{
+    return getSourceAddress(aAddress.c_str());
 }
 
 void KnxTpUart::setTelegramCheckCallback(KnxTelegramCheckType aCallback)
@@ -955,29 +1707,37 @@ void KnxTpUart::setTelegramCheckCallback(KnxTelegramCheckType aCallback)
 	mTelegramCheckCallback = aCallback;
 }
 
+void KnxTpUart::setClock(KnxClock* aClock)
+{
+    mClock = (aClock != NULL) ? aClock : &sArduinoClock;
+    // the timestamps taken so far belong to the former clock
+    mTxCreditTime   = mClock->getMicros();
+    mRxLastByteTime = mTxCreditTime;
+    mTxResyncTime   = mTxCreditTime;
+    #ifdef KNX_SUPPORT_TX_QUEUE
+        mTxStartTime = mTxCreditTime;
+        mTxRetryTime = mClock->getMillis();
+    #endif
+}
+
 #ifdef KNX_SUPPORT_LISTEN_GAS
 
-bool KnxTpUart::setListenAddressCount(uint8_t aCount)
+bool KnxTpUart::setListenAddressCount(uint16_t aCount)
 {
-	if (mListenGAs != NULL)
-	{
-		// free the previously allocated buffer
-		free(mListenGAs);
-		mListenGAs = NULL;
-	}
-	mListenGAsCount = 0;
+	return mListenGAs.setCapacity(aCount);
+}
 
-	// allocate new buffer (2 bytes per address)
-	mListenGAs      = (uint16_t *)malloc(2*aCount);
-	if (mListenGAs == NULL)
-	{
-		// not possible to allocate buffer
-		mListenGAsMax = 0;
-		return false;
-	}
+void KnxTpUart::clearListenGroupAddresses()
+{
+	mListenGAs.clear();
+	#ifdef KNX_SUPPORT_GROUP_HANDLERS
+		mListenedGroupHandler = false;
+	#endif
+}
 
-	mListenGAsMax   = aCount;
-	return true;
+uint16_t KnxTpUart::getListenGroupAddressCount()
+{
+	return mListenGAs.getCount();
 }
 
 
@@ -987,15 +1747,16 @@ bool KnxTpUart::addListenGroupAddress(String aAddress) {
 
 bool KnxTpUart::addListenGroupAddress(uint16_t aAddress)
 {
-    if (mListenGAsCount >= mListenGAsMax)
+    if (!mListenGAs.add(aAddress))
     {
 #if defined(TPUART_DEBUG)
-    TPUART_DEBUG_PORT.println("Maximum number of listening addresses already added.");
+    TPUART_DEBUG_PORT.println("No memory left for listening address.");
 #endif
     return false;
     }
-    mListenGAs[mListenGAsCount] = aAddress;
-    mListenGAsCount++;
+    #ifdef KNX_SUPPORT_GROUP_HANDLERS
+        mListenedGroupHandler |= (mGroupHandlers.find(aAddress) != NULL);
+    #endif
     return true;
 }
 
@@ -1005,14 +1766,66 @@ bool KnxTpUart::isListeningToGroupAddress(uint8_t main, uint8_t middle, uint8_t
 
 bool KnxTpUart::isListeningToGroupAddress(uint16_t aAddress)
 {
-    for (int i = 0; i < mListenGAsCount; i++)
+    return mListenGAs.contains(aAddress);
+}
+
+#endif
+
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+
+bool KnxTpUart::addGroupHandler(uint16_t aAddress, KnxGroupHandlerType aHandler, void* aContext)
+{
+    return addGroupHandler(aAddress, aAddress, aHandler, aContext);
+}
+
+bool KnxTpUart::addGroupHandler(uint16_t aFirst, uint16_t aLast, KnxGroupHandlerType aHandler, void* aContext)
+{
+    if (!mGroupHandlers.add(aFirst, aLast, aHandler, aContext))
     {
-        if (mListenGAs[i] == aAddress)
+#if defined(TPUART_DEBUG)
+    TPUART_DEBUG_PORT.println("Group handler overlaps or no memory left.");
+#endif
+    return false;
+    }
+
+    #ifdef KNX_SUPPORT_LISTEN_GAS
+        // only done when binding, a range is checked address by address
+        for (uint32_t address = aFirst; address <= aLast && !mListenedGroupHandler && mListenGAs.getCount() > 0; address++)
         {
-        	return true;
+            mListenedGroupHandler = mListenGAs.contains(address);
         }
-    }
-    return false;
+    #endif
+    return true;
+}
+
+bool KnxTpUart::removeGroupHandler(uint16_t aAddress)
+{
+    return mGroupHandlers.remove(aAddress);
+}
+
+void KnxTpUart::clearGroupHandlers()
+{
+    mGroupHandlers.clear();
+    mListenedGroupHandler = false;
+}
+
+#endif
+
+#ifdef KNX_SUPPORT_SEND_FILTER
+
+bool KnxTpUart::addSendFilter(uint16_t aAddress, KnxSendFilterValueType aType, float aAbsolute, uint8_t aRelative, uint16_t aMaxInterval)
+{
+    return mSendFilter.add(aAddress, aType, aAbsolute, aRelative, aMaxInterval);
+}
+
+bool KnxTpUart::removeSendFilter(uint16_t aAddress)
+{
+    return mSendFilter.remove(aAddress);
+}
+
+void KnxTpUart::clearSendFilters()
+{
+    mSendFilter.clear();
 }
 
 #endif
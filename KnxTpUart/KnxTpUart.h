@@ -12,7 +12,15 @@
 
 #include "Arduino.h"
 
+#include "KnxClock.h"
 #include "KnxTelegram.h"
+#include "KnxFrameView.h"
+#include "KnxAddress.h"
+#include "KnxRingBuffer.h"
+#include "KnxListenTable.h"
+#include "KnxGroupHandlerTable.h"
+#include "KnxSendFilter.h"
+#include "KnxTelegramTemplate.h"
 
 // Services from TPUART
 #define TPUART_RESET_INDICATION_BYTE B11
@@ -40,29 +48,171 @@
 #define TPUART_DEBUG_PORT Serial
 
 
-// Delay in ms between sending of packets to the bus
-// Change only if you know what you're doing
-//#define SERIAL_WRITE_DELAY_MS 100
+// Baud rate of the UART between host and TP-UART (8E1), the receive and confirmation deadlines
+// are derived from it, see KnxTpUart::setTimeouts().
+#define KNX_HOST_BAUDRATE 19200
 
-// Timeout for reading a byte from TPUART
-// Change only if you know what you're doing
-#define SERIAL_READ_TIMEOUT_MS 10
+// Time in us added to every receive and confirmation deadline for the latency of TP-UART and host.
+#define KNX_TIMEOUT_SLACK_US 2000
 
 // If KNX_SUPPORT_LISTEN_GAS is defined listening GAs can be added.
 #define KNX_SUPPORT_LISTEN_GAS
 
+// Storage of the listening GAs, define exactly one of:
+// KNX_LISTEN_GAS_LINEAR - unsorted array, linear search (smallest code, 2 byte RAM per GA)
+// KNX_LISTEN_GAS_SORTED - sorted array, binary search (2 byte RAM per GA)
+// KNX_LISTEN_GAS_RANGES - sorted runs of consecutive GAs, binary search (4 byte RAM per run)
+// KNX_LISTEN_GAS_HASH   - hash table, constant time search (4 byte RAM or more per GA)
+// KNX_LISTEN_GAS_BITMAP - one bit per possible GA, single bit test (fixed 8 KiB RAM)
+// KNX_LISTEN_GAS_PAGED  - 32 byte bitmap page per used main/middle group, single bit test
+// All tables grow on demand when addresses are added.
+#define KNX_LISTEN_GAS_SORTED
+
+#if defined(KNX_LISTEN_GAS_BITMAP)
+typedef KnxListenTableBitmap KnxListenTableType;
+#elif defined(KNX_LISTEN_GAS_PAGED)
+typedef KnxListenTablePaged KnxListenTableType;
+#elif defined(KNX_LISTEN_GAS_RANGES)
+typedef KnxListenTableRanges KnxListenTableType;
+#elif defined(KNX_LISTEN_GAS_HASH)
+typedef KnxListenTableHash KnxListenTableType;
+#elif defined(KNX_LISTEN_GAS_SORTED)
+typedef KnxListenTableSorted KnxListenTableType;
+#else
+typedef KnxListenTableLinear KnxListenTableType;
+#endif
+
+// If KNX_SUPPORT_GROUP_HANDLERS is defined handlers can be bound to group addresses,
+// received telegrams to these addresses are dispatched directly from serialEvent().
+// Uncomment to enable, it costs about 20 byte RAM plus 8 byte per handler (AVR).
+//#define KNX_SUPPORT_GROUP_HANDLERS
+
+// If KNX_SUPPORT_TX_QUEUE is defined telegrams can be queued for sending, see KnxTpUart::queueTelegram().
+// The queue is serviced from serialEvent(), the caller does not wait for the bus.
+// Uncomment to enable, it costs KNX_TX_QUEUE_SIZE times the RAM given below plus about 20 byte.
+//#define KNX_SUPPORT_TX_QUEUE
+
+// Number of telegrams the send queue can take, each one costs MAX_KNX_TELEGRAM_SIZE + 2 pointers RAM.
+#define KNX_TX_QUEUE_SIZE 4
+
+// Maximum number of transmissions of a telegram the TP-UART does not confirm, see KnxTpUart::setSendRetries().
+// The TP-UART itself repeats a telegram that is not acknowledged on the bus up to 3 times, these attempts come on top.
+#define KNX_TX_MAX_ATTEMPTS 3
+
+// Time in ms before the first retransmission of a telegram, it doubles with every further attempt.
+#define KNX_TX_RETRY_BACKOFF_MS 20
+
+#if KNX_TX_MAX_ATTEMPTS < 1
+#error "KNX_TX_MAX_ATTEMPTS must be at least 1"
+#endif
+
+// If KNX_SUPPORT_SEND_FILTER is defined group writes can be filtered per group address, so unchanged values
+// are not sent again, see KnxTpUart::addSendFilter(). Uncomment to enable.
+//#define KNX_SUPPORT_SEND_FILTER
+
+// Number of group addresses that can have a send filter, each one costs about 36 byte RAM.
+#define KNX_SEND_FILTER_SIZE 4
+
+// Bus load governor: outgoing telegrams are paced by a token bucket, see KnxTpUart::setBusLoadLimit().
+// It is off by default, set one of the limits (e.g. 20 telegrams per second, 40 %) here or at runtime to enable it.
+// Maximum number of telegrams per second sent on average, 0 for no limit.
+#define KNX_TX_MAX_TELEGRAMS_PER_SECOND 0
+
+// Maximum share of the bus time in percent used by own telegrams on average, 0 for no limit.
+#define KNX_TX_MAX_BUS_LOAD_PERCENT 0
+
+// Time in ms the governor saves up while nothing is sent, this is sent as burst without pacing.
+#define KNX_TX_BURST_MS 250
+
+// Baud rate of the KNX TP1 bus, used to calculate the time a telegram occupies the bus.
+#define KNX_BUS_BAUDRATE 9600
+
+// Number of telegram buffers for received telegrams (at least 2).
+// Telegrams received while the application is busy (e.g. sending) are queued in these buffers,
+// each one costs MAX_KNX_TELEGRAM_SIZE + 2 byte RAM. Increase to take bursts like scene recalls.
+#define KNX_RX_QUEUE_SIZE 2
+
+#if KNX_RX_QUEUE_SIZE < 2
+#error "KNX_RX_QUEUE_SIZE must be at least 2"
+#endif
+
+// If KNX_SUPPORT_RX_RING is defined received bytes are read from a ring buffer that is filled by a UART
+// interrupt or an adapter through KnxTpUart::pushReceivedByte(), the Stream is read once the ring is empty.
+//#define KNX_SUPPORT_RX_RING
+
+// Size of the receive ring buffer, must be a power of two (max 128)
+#define KNX_RX_RING_SIZE 64
+
 /**
  * Definition of callback function type to allow application to check if telegram is of interest
  */
 typedef bool (*KnxTelegramCheckType)(KnxTelegram *aTelegram);
 
+/**
+ * Result of sending a queued telegram.
+ */
+enum KnxTpUartSendResultType
+{
+  KNX_SEND_CONFIRMED,      // the TP-UART confirmed the transmission (TPUART_SEND_SUCCESS)
+  KNX_SEND_NOT_CONFIRMED,  // the TP-UART reported a failed transmission (TPUART_SEND_NOT_SUCCESS)
+  KNX_SEND_TIMEOUT,        // no confirmation in time, see KnxTpUart::getConfirmTimeout()
+  KNX_SEND_SUPPRESSED      // not sent because the send filter found the value unchanged
+};
+
+/**
+ * Definition of callback function type called when a queued telegram was sent.
+ * @param aTelegram the telegram sent, only valid during the call.
+ * @param aResult the result of sending.
+ * @param aContext the context pointer given when the telegram was queued.
+ * The callback may queue further telegrams but must not use the blocking send functions.
+ */
+typedef void (*KnxSendCallbackType)(KnxTelegram *aTelegram, KnxTpUartSendResultType aResult, void *aContext);
+
+/**
+ * Statistics of the telegrams sent, see KnxTpUart::getSendStatistics().
+ * Many retransmissions hint at a bad line (noise, missing ACKs, overload).
+ */
+struct KnxTpUartSendStatistics
+{
+  uint32_t telegrams;                            // telegrams finished, confirmed or given up
+  uint32_t attempts;                             // transmissions including retransmissions
+  uint32_t failed;                               // telegrams given up after the last attempt
+  uint32_t suppressed;                           // group writes not sent because of the send filter
+  uint32_t confirmedAfter[KNX_TX_MAX_ATTEMPTS];  // confirmed telegrams by attempt, index 0 is the first one
+};
+
 enum KnxTpUartSerialEventType
 {
   TPUART_RESET_INDICATION,
   KNX_TELEGRAM,
   IRRELEVANT_KNX_TELEGRAM,
   TIMEOUT,
-  UNKNOWN
+  UNKNOWN,
+  INCOMPLETE_KNX_TELEGRAM,
+  DISPATCHED_KNX_TELEGRAM
+};
+
+/**
+ * States of a receive telegram buffer.
+ */
+enum KnxTpUartRxSlotStateType
+{
+  KNX_RX_SLOT_FREE,       // not in use
+  KNX_RX_SLOT_RECEIVING,  // the receiver writes into it
+  KNX_RX_SLOT_QUEUED,     // complete, waiting to be handed to the application
+  KNX_RX_SLOT_DELIVERED   // handed to the application by the last serialEvent()
+};
+
+/**
+ * States of the incremental telegram receiver.
+ */
+enum KnxTpUartRxStateType
+{
+  KNX_RX_IDLE,      // waiting for a control byte
+  KNX_RX_HEADER,    // reading source and target address
+  KNX_RX_LENGTH,    // reading address type, routing counter and length
+  KNX_RX_PAYLOAD,   // reading the payload
+  KNX_RX_CHECKSUM   // reading the checksum
 };
 
 class KnxTpUart {
@@ -85,7 +235,8 @@ class KnxTpUart {
 
     /**
      * Perform a UART connection reset.
-     * This method sends a 0x01 to the UART port.
+     * This method sends a 0x01 to the UART port. The TP-UART discards the telegrams it was given,
+     * confirmations received until its reset indication are ignored.
      */
     void uartReset();
 
@@ -97,16 +248,38 @@ class KnxTpUart {
 
     /**
      * Has to be called to fetch a telegram from the UART communication port.
+     * This method never blocks, it only consumes the bytes that are already available.
+     * All complete telegrams are acknowledged and queued, the oldest one is handed out per call.
+     * If a telegram is not yet complete INCOMPLETE_KNX_TELEGRAM is returned and the next call continues it.
+     * A telegram to a group address with a handler (see #addGroupHandler()) is passed to the handler
+     * and DISPATCHED_KNX_TELEGRAM is returned instead of KNX_TELEGRAM.
      * @return a enum value to indicate if a KNX telegram of interest can be read or not.
      */
     KnxTpUartSerialEventType serialEvent();
 
     /**
      * Retrieve the current telegram for further processing.
+     * Sending does not modify the received telegram, it stays valid until the next call of #serialEvent().
      * @return a pointer to the current telegram. This is only valid if #serialEvent() returned KNX_TELEGRAM.
      */
     KnxTelegram* getReceivedTelegram();
 
+    /**
+     * Same as #getReceivedTelegram() but as read only view of the received bytes.
+     * @return a view of the current telegram. This is only valid if #serialEvent() returned KNX_TELEGRAM.
+     */
+    KnxFrameView getReceivedFrame();
+
+    /**
+     * @return the number of received telegrams queued and not yet handed out by #serialEvent().
+     */
+    uint8_t getReceivedTelegramCount();
+
+    /**
+     * @return the number of received telegrams dropped because all receive buffers were in use.
+     */
+    uint16_t getReceiveQueueOverflowCount();
+
     /*
      * Set the individual device address by passing in 3 parts.
      * @param aArea the area id (4 bit).
@@ -131,6 +304,37 @@ class KnxTpUart {
      */
     void sendNotAddressed();
 
+    /**
+     * Send a value of the given datapoint type to a group address, e.g.:
+     * <pre>
+     * knx.groupWrite<KnxDpt9>(KNX_GA(1,2,3), 21.5);
+     * </pre>
+     * All groupWrite* functions below are shortcuts for this one, see KnxDpt.h for the types.
+     * @param aAddress the address to write to.
+     * @param aValue the value to write.
+     * @return true if writing was successful, false otherwise.
+     * @see #groupAnswer
+     */
+    template<typename Dpt>
+    bool groupWrite(uint16_t aAddress, typename Dpt::Type aValue)
+    {
+        return sendGroupValue<Dpt>(KNX_COMMAND_WRITE, aAddress, aValue);
+    }
+
+    /**
+     * Answer a read request with a value of the given datapoint type, e.g. groupAnswer<KnxDpt5>(address, 42).
+     * All groupAnswer* functions below are shortcuts for this one, see KnxDpt.h for the types.
+     * @param aAddress the address to answer to.
+     * @param aValue the value to answer.
+     * @return true if writing was successful, false otherwise.
+     * @see #groupWrite
+     */
+    template<typename Dpt>
+    bool groupAnswer(uint16_t aAddress, typename Dpt::Type aValue)
+    {
+        return sendGroupValue<Dpt>(KNX_COMMAND_ANSWER, aAddress, aValue);
+    }
+
     /**
      * Send a boolean (1bit) value to a group address.
      * This can be used for DPT-1.
@@ -554,30 +758,240 @@ class KnxTpUart {
     /**
      * Converts a String of the form 1/2/3 into a 2 byte group address.
      * @param aAddress the address to parse.
-     * @return the two byte address.
+     * @return the two byte address, 0 if the text is not a valid group address.
+     * @see KnxAddress#parseGroupAddress to get the reason of an error.
      */
-    uint16_t getGroupAddress(String aAddress);
+    uint16_t getGroupAddress(const char* aAddress);
+    uint16_t getGroupAddress(const String& aAddress);
 
     /**
 	 * Converts a String of the form 1.2.3 into a 2 byte individual address.
 	 * @param aAddress the address to parse.
-	 * @return the two byte address.
+	 * @return the two byte address, 0 if the text is not a valid individual address.
+	 * @see KnxAddress#parseIndividualAddress to get the reason of an error.
 	 */
-    uint16_t getSourceAddress(String aAddress);
+    uint16_t getSourceAddress(const char* aAddress);
+    uint16_t getSourceAddress(const String& aAddress);
 
     /**
      * Set a callback function that is called within telegram receive and checks if the telegram is of interest or not.
+     * The callback is called as soon as the target address is received to meet the acknowledge deadline,
+     * so only the header (source, target, routing counter and length) of the telegram is valid at that time.
      * @param aCallback the callback function that is used to check if a telegram is of interest.
      */
     void setTelegramCheckCallback(KnxTelegramCheckType aCallback);
 
+    /**
+     * Set the clock all timestamps and timeouts are taken from and that is called while waiting for bytes.
+     * @param aClock the clock, it has to live as long as this instance. NULL for the Arduino clock.
+     */
+    void setClock(KnxClock* aClock);
+
     /**
      * Send the given telegram to bus.
-     * @param aTelegram the telegram to send.
+     * This waits until the telegram was confirmed by the TP-UART. Telegrams queued before are sent first.
+     * A telegram that is not confirmed is retransmitted as configured by #setSendRetries(),
+     * received telegrams are queued meanwhile.
+     * @param aTelegram the telegram to send, it is not modified.
      * @return true if send (and receive) was successful, false otherwise.
      */
     bool sendTelegram(KnxTelegram* aTelegram);
 
+    /**
+     * Configure the retransmission of telegrams the TP-UART reports as not sent (TPUART_SEND_NOT_SUCCESS)
+     * or does not confirm in time. Retransmissions have the repeat flag set (see KnxTelegram::setRepeated()),
+     * the wait before them starts with aBackoffMs and doubles with every attempt.
+     * This applies to #sendTelegram(), groupWrite*, groupAnswer* and queued telegrams alike.
+     * @param aMaxAttempts the number of transmissions per telegram (1 to KNX_TX_MAX_ATTEMPTS, default
+     *        KNX_TX_MAX_ATTEMPTS), 1 disables retransmissions.
+     * @param aBackoffMs the time in ms before the first retransmission (default KNX_TX_RETRY_BACKOFF_MS).
+     */
+    void setSendRetries(uint8_t aMaxAttempts, uint16_t aBackoffMs);
+
+    /**
+     * Limit the rate of outgoing telegrams. The governor is a token bucket: while nothing is sent
+     * up to KNX_TX_BURST_MS of credit are saved, each telegram costs the larger of 1 / aTelegramsPerSecond
+     * and its bus time (see #getBusTime()) divided by aLoadPercent. When the credit is used up the next
+     * telegram waits, blocking sends keep receiving meanwhile and queued telegrams stay in the queue.
+     * @param aTelegramsPerSecond the average number of telegrams per second, 0 for no limit
+     *        (default KNX_TX_MAX_TELEGRAMS_PER_SECOND).
+     * @param aLoadPercent the average bus load in percent caused by own telegrams, 0 for no limit
+     *        (default KNX_TX_MAX_BUS_LOAD_PERCENT).
+     */
+    void setBusLoadLimit(uint8_t aTelegramsPerSecond, uint8_t aLoadPercent);
+
+    /**
+     * The time a telegram occupies the bus at KNX_BUS_BAUDRATE: the idle time of 50 bit before it,
+     * 13 bit (11 bit character plus 2 bit pause) per byte and the acknowledge of 15 bit pause plus 11 bit.
+     * @param aTotalLength the length of the telegram (see KnxTelegram::getTotalLength()).
+     * @return the time in microseconds.
+     */
+    static unsigned long getBusTime(uint8_t aTotalLength);
+
+    /**
+     * Set the link to the TP-UART the deadlines of receiving and sending are derived from.
+     * The bytes of a telegram arrive one byte time apart, the longer of a character on the host link
+     * and on the bus. A telegram being received is dropped (TIMEOUT) if its next byte is more than a
+     * byte time plus the slack overdue or if it is not complete within its length (taken from the
+     * length field) in byte times plus the slack. A blocking send waits for the confirmation as long
+     * as writing the frame and sending it on the bus with all repetitions of the TP-UART takes.
+     * @param aHostBaudrate the baud rate of the UART to the TP-UART (default KNX_HOST_BAUDRATE).
+     * @param aSlackUs the time in us added to every deadline (default KNX_TIMEOUT_SLACK_US).
+     */
+    void setTimeouts(unsigned long aHostBaudrate, unsigned long aSlackUs = KNX_TIMEOUT_SLACK_US);
+
+    /**
+     * @return the time in us after the last byte a telegram being received is dropped.
+     */
+    unsigned long getByteTimeout();
+
+    /**
+     * @return the time in us a send, blocking or queued, waits for the confirmation of a telegram of
+     * the given length after writing it or after the last byte received meanwhile.
+     */
+    unsigned long getConfirmTimeout(uint8_t aTotalLength);
+
+    /**
+     * @return the statistics of the telegrams sent since the start or the last #resetSendStatistics().
+     */
+    const KnxTpUartSendStatistics* getSendStatistics();
+
+    /**
+     * Reset all send statistics to zero.
+     */
+    void resetSendStatistics();
+
+    /**
+     * Encode the given telegram for the TP-UART: each byte is preceded by TPUART_DATA_START_CONTINUE | index,
+     * the last one by TPUART_DATA_END | index.
+     * @param aTelegram the telegram to encode, the checksum must already be set.
+     * @param aFrame the buffer to write to, TPUART_FRAME_MAX_SIZE bytes.
+     * @return the number of bytes written to aFrame.
+     */
+    static uint8_t encodeTelegram(KnxTelegram* aTelegram, uint8_t* aFrame);
+
+    /**
+     * Encode a telegram given as raw buffer for the TP-UART, see #encodeTelegram(KnxTelegram*, uint8_t*).
+     * @param aBuffer the telegram (header, payload and checksum).
+     * @param aLength the total length of the telegram.
+     * @param aFrame the buffer to write to, 2 * aLength bytes.
+     * @return the number of bytes written to aFrame.
+     */
+    static uint8_t encodeTelegram(const uint8_t* aBuffer, uint8_t aLength, uint8_t* aFrame);
+
+    /**
+     * Send a telegram given as raw buffer (header, payload and checksum), e.g. a frame built once and kept.
+     * The buffer is encoded for the TP-UART directly, it is neither copied nor modified.
+     * Retransmission and bus load governor apply as for #sendTelegram(KnxTelegram*), the send filter does not.
+     * @param aBuffer the telegram.
+     * @param aLength the total length of the telegram, it must match the length field of the header.
+     * @return true if the TP-UART confirmed the telegram, false if it did not or aLength is invalid.
+     */
+    bool sendTelegram(const uint8_t* aBuffer, uint8_t aLength);
+
+    /**
+     * Send a pre-encoded telegram. The frame of the template is written as it is, so only setting its value
+     * costs CPU time. Retransmission and bus load governor apply as for #sendTelegram(KnxTelegram*),
+     * the send filter does not.
+     * @param aTemplate the template, its frame is not modified.
+     * @return true if the TP-UART confirmed the telegram, false if it did not or the template is empty.
+     */
+    bool sendTemplate(KnxTelegramTemplate* aTemplate);
+
+    /**
+     * Prepare a group telegram in a caller owned buffer instead of the internal one used by groupWrite*.
+     * Source (own individual address), target, command and first data byte are set, the value is then set with
+     * the KnxTelegram setters and the telegram finished with a single KnxTelegram::createChecksum():
+     * <pre>
+     * knx.buildGroupTelegram(&telegram, KNX_COMMAND_WRITE, KNX_GA(1,2,3));
+     * telegram.set2ByteFloatValue(21.5);
+     * telegram.createChecksum();
+     * knx.sendTelegram(&telegram);
+     * </pre>
+     * @param aTelegram the telegram to fill, it is cleared first.
+     * @param aCommand the command.
+     * @param aAddress the target group address.
+     * @param aFirstDataByte the value of short telegrams (up to 6 bit, e.g. DPT-1).
+     */
+    void buildGroupTelegram(KnxTelegram* aTelegram, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte = 0);
+
+    /**
+     * Prepare a telegram to an individual address in a caller owned buffer, see #buildGroupTelegram().
+     * @param aTelegram the telegram to fill, it is cleared first.
+     * @param aCommand the command.
+     * @param aAddress the target individual address.
+     * @param aFirstDataByte the first data byte.
+     */
+    void buildIndividualTelegram(KnxTelegram* aTelegram, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte = 0);
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+    /**
+     * Queue the given telegram for sending and return immediately.
+     * The telegram is copied, so the caller can reuse it. Queued telegrams are sent in order of their
+     * priority (system, alarm, high, normal) and in order of queueing within the same priority.
+     * Sending is driven by #serialEvent(), which has to be called frequently (e.g. from loop()).
+     * @param aTelegram the telegram to send, the checksum must already be set.
+     * @param aCallback called once the TP-UART confirmed the telegram or the last attempt failed, may be NULL.
+     * @param aContext a pointer passed to the callback unchanged.
+     * @return true if the telegram was queued (or suppressed by the send filter), false if the queue is full.
+     */
+    bool queueTelegram(KnxTelegram* aTelegram, KnxSendCallbackType aCallback = NULL, void* aContext = NULL);
+
+    /**
+     * Select how groupWrite*, groupAnswer* and groupRead send their telegram.
+     * @param aQueued true to queue the telegram and return immediately (the return value then tells
+     *        if it could be queued), false to wait for the confirmation (default).
+     */
+    void setQueuedSend(bool aQueued);
+
+    /**
+     * @return the number of queued telegrams including the one currently sent.
+     */
+    uint8_t getSendQueueCount();
+#endif
+
+#ifdef KNX_SUPPORT_SEND_FILTER
+    /**
+     * Filter the group writes to a group address: a write is only sent if the value changed by at least
+     * one of the deadbands (by anything if none is set) or the last write is older than aMaxInterval.
+     * Suppressed writes report success (#sendTelegram()) or KNX_SEND_SUPPRESSED (#queueTelegram()),
+     * they are counted in the send statistics. A write that could not be sent is not remembered.
+     * @param aAddress the group address.
+     * @param aType how to read the value for the deadbands, KNX_FILTER_RAW to compare the payload only.
+     * @param aAbsolute the minimum absolute change to send, 0 for none.
+     * @param aRelative the minimum change in percent of the last value sent, 0 for none.
+     * @param aMaxInterval the time in seconds after which an unchanged value is sent again, 0 for never.
+     * @return true if the filter was added, false if KNX_SEND_FILTER_SIZE filters are in use.
+     */
+    bool addSendFilter(uint16_t aAddress, KnxSendFilterValueType aType, float aAbsolute = 0, uint8_t aRelative = 0, uint16_t aMaxInterval = 0);
+
+    /**
+     * Remove the send filter of a group address.
+     * @return true if there was one.
+     */
+    bool removeSendFilter(uint16_t aAddress);
+
+    /**
+     * Remove all send filters.
+     */
+    void clearSendFilters();
+#endif
+
+#ifdef KNX_SUPPORT_RX_RING
+    /**
+     * Hand a byte received from the UART to the telegram receiver.
+     * This is safe to be called from an interrupt while the main loop calls #serialEvent().
+     * @param aByte the received byte.
+     * @return true if the byte was queued, false if the ring buffer was full.
+     */
+    bool pushReceivedByte(uint8_t aByte);
+
+    /**
+     * @return the number of received bytes lost because the ring buffer was full, it stops at 255.
+     */
+    uint8_t getReceiveOverrunCount();
+#endif
+
 #ifdef KNX_SUPPORT_LISTEN_GAS
 
     bool addListenGroupAddress(String aAddress);
@@ -588,13 +1002,58 @@ class KnxTpUart {
 
 
     /**
-     * Set the maximum number of listening group addresses.
-     * This need to be called before a listening GA is added by calling addListenGroupAddress(aAddress).
-     * This will clear all previously assigned addresses.
-     * This method will reserve 2 byte RAM for each address.
-     * @param aCount the maximum number of addresses to be allowed.
+     * Reserve memory for the given number of listening group addresses.
+     * Calling this is optional, the table grows when addresses are added, but reserving up front
+     * avoids repeated reallocation. Previously added addresses are kept.
+     * This method will reserve 2 byte RAM for each address (4 or more with KNX_LISTEN_GAS_HASH,
+     * 4 per run with KNX_LISTEN_GAS_RANGES, nothing with KNX_LISTEN_GAS_BITMAP or KNX_LISTEN_GAS_PAGED).
+     * @param aCount the number of addresses to reserve memory for.
+     * @return true if the memory could be allocated, false otherwise.
+     */
+    bool setListenAddressCount(uint16_t aCount);
+
+    /**
+     * Remove all listening group addresses.
+     */
+    void clearListenGroupAddresses();
+
+    /**
+     * @return the number of listening group addresses, 0xFFFF if all 65536 were added.
+     */
+    uint16_t getListenGroupAddressCount();
+
+#endif
+
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+
+    /**
+     * Bind a handler to a group address. Telegrams to this address are acknowledged and passed to
+     * the handler from #serialEvent(), no listening GA is needed.
+     * @param aAddress the group address.
+     * @param aHandler the handler to call.
+     * @param aContext a pointer passed to the handler unchanged.
+     * @return true if the handler was added, false if the address already has a handler within a range
+     *         or no memory was left.
+     */
+    bool addGroupHandler(uint16_t aAddress, KnxGroupHandlerType aHandler, void* aContext = NULL);
+
+    /**
+     * Bind a handler to all group addresses from aFirst to aLast (both included).
+     * @return true if the handler was added, false if the range overlaps another one or no memory was left.
+     * @see #addGroupHandler(uint16_t, KnxGroupHandlerType, void*)
+     */
+    bool addGroupHandler(uint16_t aFirst, uint16_t aLast, KnxGroupHandlerType aHandler, void* aContext = NULL);
+
+    /**
+     * Remove the handler bound to the given group address (the whole range it belongs to).
+     * @return true if a handler was removed, false otherwise.
+     */
+    bool removeGroupHandler(uint16_t aAddress);
+
+    /**
+     * Remove all group handlers.
      */
-    bool setListenAddressCount(uint8_t aCount);
+    void clearGroupHandlers();
 
 #endif
 
@@ -606,11 +1065,73 @@ class KnxTpUart {
     Stream* _serialport;
 
     /**
-     * The KNX telegram buffer used for normal communication.
+     * The KNX telegram buffer used for sending.
      * This is allocated in constructor but never freed!
      */
     KnxTelegram* _tg;
 
+    /**
+     * The pool of buffers for received telegrams.
+     */
+    KnxTelegram mRxSlots[KNX_RX_QUEUE_SIZE];
+
+    /**
+     * The state of each receive buffer, see KnxTpUartRxSlotStateType.
+     */
+    uint8_t mRxSlotState[KNX_RX_QUEUE_SIZE];
+
+    /**
+     * The acknowledge decision of each receive buffer.
+     */
+    bool mRxSlotInterested[KNX_RX_QUEUE_SIZE];
+
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+    /**
+     * The group handler of each receive buffer found with the acknowledge decision, NULL if none.
+     */
+    KnxGroupHandlerType mRxSlotHandler[KNX_RX_QUEUE_SIZE];
+
+    /**
+     * The context of the handler in mRxSlotHandler.
+     */
+    void* mRxSlotHandlerContext[KNX_RX_QUEUE_SIZE];
+#endif
+
+    /**
+     * FIFO of complete telegrams (buffer indices) in order of reception.
+     */
+    uint8_t mRxQueue[KNX_RX_QUEUE_SIZE];
+
+    /**
+     * Position of the oldest entry in mRxQueue.
+     */
+    uint8_t mRxQueueHead;
+
+    /**
+     * Number of entries in mRxQueue.
+     */
+    uint8_t mRxQueueCount;
+
+    /**
+     * Number of telegrams dropped because all receive buffers were in use.
+     */
+    uint16_t mRxQueueOverflowCount;
+
+    /**
+     * The receive buffer handed to the application by the last #serialEvent().
+     */
+    uint8_t mRxDelivered;
+
+    /**
+     * The receive buffer the current telegram is written into.
+     */
+    uint8_t mRxSlot;
+
+    /**
+     * Pointer to the buffer at mRxSlot.
+     */
+    KnxTelegram* mRxTelegram;
+
     /**
      * The KNX source address used in default KnxTelegrams.
      */
@@ -618,18 +1139,238 @@ class KnxTpUart {
 
 #ifdef KNX_SUPPORT_LISTEN_GAS
     /**
-     * The list of group addresses to listen to.
+     * The group addresses to listen to.
+     */
+    KnxListenTableType mListenGAs;
+#endif
+
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+    /**
+     * The handlers bound to group addresses.
+     */
+    KnxGroupHandlerTable mGroupHandlers;
+
+    /**
+     * True if a handler was bound to a listened GA, received telegrams to listened GAs then need a handler
+     * lookup as well. Only reset by #clearGroupHandlers() and #clearListenGroupAddresses().
+     */
+    bool mListenedGroupHandler;
+
+    /**
+     * The handler of the current telegram, found with the acknowledge decision, NULL if none.
+     */
+    KnxGroupHandlerType mRxHandler;
+
+    /**
+     * The context of mRxHandler.
      */
-    uint16_t *mListenGAs;
+    void* mRxHandlerContext;
+#endif
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+    /**
+     * The buffers of queued telegrams.
+     */
+    KnxTelegram mTxSlots[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * The completion callback of each send buffer.
+     */
+    KnxSendCallbackType mTxCallback[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * The callback context of each send buffer.
+     */
+    void* mTxContext[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * True for each send buffer in use.
+     */
+    bool mTxSlotUsed[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * The used send buffers (indices) in order of sending, the first one is sent next or currently.
+     */
+    uint8_t mTxOrder[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * Number of entries in mTxOrder.
+     */
+    uint8_t mTxCount;
+
+    /**
+     * True while the first telegram of mTxOrder was written and waits for its confirmation.
+     */
+    bool mTxActive;
+
+    /**
+     * The time (micros) the active telegram was written.
+     */
+    unsigned long mTxStartTime;
+
+    /**
+     * True if groupWrite* and friends queue their telegram instead of waiting for the confirmation.
+     */
+    bool mTxQueuedSend;
+
+    /**
+     * The number of transmissions of each send buffer so far.
+     */
+    uint8_t mTxAttempts[KNX_TX_QUEUE_SIZE];
+
+    /**
+     * The time (millis) the last transmission of a queued telegram failed.
+     */
+    unsigned long mTxRetryTime;
+
+    /**
+     * The time in ms to wait after mTxRetryTime before the next queued telegram is written.
+     */
+    unsigned long mTxRetryDelay;
+#endif
+
+    /**
+     * The number of transmissions per telegram, see #setSendRetries().
+     */
+    uint8_t mTxMaxAttempts;
+
+    /**
+     * The time in ms before the first retransmission.
+     */
+    uint16_t mTxRetryBackoff;
+
+    /**
+     * The statistics of the telegrams sent.
+     */
+    KnxTpUartSendStatistics mTxStatistics;
+
+    /**
+     * The maximum number of telegrams per second, 0 for no limit.
+     */
+    uint8_t mTxRateLimit;
+
+    /**
+     * The maximum bus load in percent, 0 for no limit.
+     */
+    uint8_t mTxLoadLimit;
+
+    /**
+     * The send credit of the governor in microseconds, negative while telegrams have to wait.
+     */
+    long mTxCredit;
+
+    /**
+     * The time (micros) mTxCredit was updated.
+     */
+    unsigned long mTxCreditTime;
+
+#ifdef KNX_SUPPORT_SEND_FILTER
+    /**
+     * The send filters of group writes.
+     */
+    KnxSendFilter<KNX_SEND_FILTER_SIZE> mSendFilter;
+#endif
+
+#ifdef KNX_SUPPORT_RX_RING
+    /**
+     * Bytes received from the UART but not yet processed.
+     */
+    KnxRingBuffer<KNX_RX_RING_SIZE> mRxRing;
+#endif
 
     /**
-     * The number of registered group addresses.
+     * True while a blocking send waits for the confirmation of its telegram.
      */
-    uint8_t mListenGAsCount;
+    bool mSendPending;
 
-    uint8_t mListenGAsMax;
+    /**
+     * True while a send waits, the receiver then consumes all bytes even if the receive queue is full.
+     */
+    bool mSendWaiting;
+
+    /**
+     * The confirmation byte received for the blocking send or -1.
+     */
+    int mSendConfirmation;
+
+#ifndef KNX_SUPPORT_TX_QUEUE
+    /**
+     * Number of NCD confirms written whose TP-UART confirmation was not received yet, see #sendNCDPosConfirm().
+     */
+    uint8_t mTxUnconfirmed;
 #endif
 
+    /**
+     * True after #uartReset() until the reset indication arrived, confirmations meanwhile are late ones
+     * of telegrams the reset discarded.
+     */
+    bool mTxResync;
+
+    /**
+     * The time (micros) of the last #uartReset(), without reset indication the resync ends after #getByteTimeout().
+     */
+    unsigned long mTxResyncTime;
+
+    /**
+     * True if a reset indication was received while a send waited, the next #serialEvent() returns it.
+     */
+    bool mResetIndicationPending;
+
+    /**
+     * The current state of the telegram receiver.
+     */
+    KnxTpUartRxStateType mRxState;
+
+    /**
+     * The number of bytes of the current telegram received so far.
+     */
+    uint8_t mRxOffset;
+
+    /**
+     * The total length of the current telegram, valid once the length byte was received.
+     */
+    uint8_t mRxLength;
+
+    /**
+     * The acknowledge decision for the current telegram, taken as soon as the target address was received.
+     */
+    bool mRxInterested;
+
+    /**
+     * The time (micros) the last byte of the current telegram was received.
+     */
+    unsigned long mRxLastByteTime;
+
+    /**
+     * The time (micros) the control byte of the current telegram was received.
+     */
+    unsigned long mRxFrameStart;
+
+    /**
+     * The time in us after mRxFrameStart the current telegram has to be complete.
+     */
+    unsigned long mRxFrameTimeout;
+
+    /**
+     * The time in us a byte takes on the link to the TP-UART, see #setTimeouts().
+     */
+    unsigned long mHostByteTime;
+
+    /**
+     * The time in us between two bytes of a received telegram, the longer of host link and bus character.
+     */
+    unsigned long mRxByteTime;
+
+    /**
+     * The time in us added to every deadline.
+     */
+    unsigned long mTimeoutSlack;
+
+    /**
+     * The clock of all timestamps and waits, never NULL.
+     */
+    KnxClock* mClock;
+
     /**
      * A flag to define if broadcast listening is requested.
      */
@@ -649,18 +1390,98 @@ class KnxTpUart {
 
     void checkErrors(void);
 
+    /**
+     * @return true if the given received byte is the late confirmation of a telegram discarded by #uartReset().
+     */
+    bool isDiscardedConfirmation(int aByte);
+
+    /**
+     * Handle a reset indication the library did not ask for: a waiting blocking send fails and the active
+     * queued telegram is not confirmed.
+     */
+    void resetIndicated();
+
     /**
      * Print a single incoming byte into debug output stream.
      */
     void printByte(uint8_t aByte);
 
     /**
-     * Read a telegram from BUS into the internal telegram buffer
+     * Consume the available bytes, acknowledge and queue all telegrams completed on the way.
+     * Stops at the first byte that is not part of a telegram or if no receive buffer is free.
+     * @return the event of that byte, or UNKNOWN / INCOMPLETE_KNX_TELEGRAM if all bytes were consumed.
+     */
+    KnxTpUartSerialEventType receive();
+
+    /**
+     * @return true if a receive buffer is free for a new telegram.
+     */
+    bool hasFreeReceiveSlot();
+
+    /**
+     * Reserve a receive buffer for a new telegram. If none is free the oldest queued telegram is dropped.
+     * @return the index of the reserved buffer.
+     */
+    uint8_t acquireReceiveSlot();
+
+    /**
+     * Append the completely received telegram to the receive queue.
+     */
+    void queueReceivedTelegram();
+
+    /**
+     * Hand the oldest queued telegram to the application.
+     * @return KNX_TELEGRAM or IRRELEVANT_KNX_TELEGRAM.
+     */
+    KnxTpUartSerialEventType deliverReceivedTelegram();
+
+    /**
+     * Free the buffer handed out by the previous #serialEvent().
+     */
+    void releaseReceivedTelegram();
+
+    /**
+     * @return the number of received bytes that can be read.
+     */
+    int rxAvailable();
+
+    /**
+     * @return the next received byte without consuming it, -1 if none is available.
+     */
+    int rxPeek();
+
+    /**
+     * @return the next received byte, -1 if none is available.
+     */
+    int rxRead();
+
+    /**
+     * Read up to aCount already received bytes.
+     * @return the number of bytes read.
+     */
+    uint8_t rxReadBytes(uint8_t* aBuffer, uint8_t aCount);
+
+    /**
+     * Continue reading a telegram from BUS into the internal telegram buffer.
+     * Only the bytes already available are consumed.
+     * @return INCOMPLETE_KNX_TELEGRAM if more bytes are required, the result of #evaluateKNXTelegram() otherwise.
      */
     KnxTpUartSerialEventType readKNXTelegram();
 
     /**
-     * Initialize the internal telegram buffer for a new message.
+     * Check if the telegram currently received is addressed to this device.
+     * Only the header (up to the address type byte) is evaluated, payload bytes are not yet received.
+     * @return true if the telegram is of interest and must be acknowledged.
+     */
+    bool isAddressed();
+
+    /**
+     * Classify and queue the completely received telegram.
+     */
+    KnxTpUartSerialEventType evaluateKNXTelegram();
+
+    /**
+     * Initialize the internal telegram buffer for a new message, the checksum is left to #sendMessage().
      * This message initializes a telegram send to a group address.
      * @param aPayloadLength the payload length
      * @param aCommand the command type
@@ -670,7 +1491,7 @@ class KnxTpUart {
     void createKNXMessageFrame(uint8_t aPayloadLength, KnxCommandType aCommand, String aAddress, uint8_t aFirstDataByte);
 
     /**
-	 * Initialize the internal telegram buffer for a new message.
+	 * Initialize the internal telegram buffer for a new message, the checksum is left to #sendMessage().
      * This message initializes a telegram send to a group address.
 	 * @param aPayloadLength the payload length
 	 * @param aCommand the command type
@@ -680,7 +1501,7 @@ class KnxTpUart {
     void createKNXMessageFrame(uint8_t aPayloadLength, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte);
 
     /**
-     * Initialize the internal telegram buffer for a new message.
+     * Initialize the internal telegram buffer for a new message, the checksum is left to #sendMessage().
      * This message initializes a telegram send to an individual device.
      * @param aPayloadLength the payload length
      * @param aCommand the command type
@@ -690,7 +1511,7 @@ class KnxTpUart {
     void createKNXMessageFrameIndividual(uint8_t aPayloadLength, KnxCommandType aCommand, String aAddress, uint8_t aFirstDataByte);
 
     /**
-     * Initialize the internal telegram buffer for a new message.
+     * Initialize the internal telegram buffer for a new message, the checksum is left to #sendMessage().
      * This message initializes a telegram send to an individual device.
      * @param aPayloadLength the payload length
      * @param aCommand the command type
@@ -700,22 +1521,139 @@ class KnxTpUart {
     void createKNXMessageFrameIndividual(uint8_t aPayloadLength, KnxCommandType aCommand, uint16_t aAddress, uint8_t aFirstDataByte);
 
     /**
-     * Send the a KNX message from internal telegram buffer.
+     * Calculate the checksum of the internal telegram buffer and send it.
      */
     bool sendMessage();
 
     /**
-     * Send a confirm message to the given address.
+     * The common path of #groupWrite() and #groupAnswer(): build the internal telegram, encode the value and send it.
+     */
+    template<typename Dpt>
+    bool sendGroupValue(KnxCommandType aCommand, uint16_t aAddress, typename Dpt::Type aValue)
+    {
+        createKNXMessageFrame(2, aCommand, aAddress, 0);
+        _tg->set<Dpt>(aValue);
+        return sendMessage();
+    }
+
+    /**
+     * Write the given telegram to the TP-UART in a single write without waiting for the confirmation.
+     * @param aBuffer the telegram to write, it is not modified.
+     * @param aLength the total length of the telegram.
+     * @param aRepeated true to send it with the repeat flag set.
+     */
+    void writeTelegram(const uint8_t* aBuffer, uint8_t aLength, bool aRepeated);
+
+    /**
+     * Write an encoded frame to the TP-UART in a single write.
+     * @param aFrame the frame, it is patched for the repeat flag during the write and restored afterwards.
+     * @param aLength the length of the frame.
+     * @param aRepeated true to send it with the repeat flag set.
+     */
+    void writeFrame(uint8_t* aFrame, uint8_t aLength, bool aRepeated);
+
+    /**
+     * Write the given telegram and wait for its confirmation, retransmit it as configured by #setSendRetries().
+     * @param aBuffer the telegram to send, it is not modified.
+     * @param aLength the total length of the telegram.
+     * @return true if the TP-UART confirmed one of the transmissions.
+     */
+    bool transmitTelegram(const uint8_t* aBuffer, uint8_t aLength);
+
+    /**
+     * Write an encoded frame and wait for its confirmation, retransmit it as configured by #setSendRetries().
+     * @param aFrame the frame to send, it is not modified.
+     * @param aLength the length of the frame.
+     * @return true if the TP-UART confirmed one of the transmissions.
+     */
+    bool transmitFrame(uint8_t* aFrame, uint8_t aLength);
+
+    /**
+     * @param aAttempts the number of transmissions so far (at least 1).
+     * @return the time in ms to wait before the next transmission.
+     */
+    unsigned long getRetryBackoff(uint8_t aAttempts);
+
+    /**
+     * Apply the send filter to a telegram about to be sent and count it if it is suppressed.
+     * @return true if the telegram is to be sent.
+     */
+    bool passSendFilter(KnxTelegram* aTelegram);
+
+    /**
+     * Add the time passed since the last call to the send credit, at most KNX_TX_BURST_MS.
+     * @return true if the governor allows a telegram to be written now.
+     */
+    bool hasSendCredit();
+
+    /**
+     * Charge the governor for a telegram written.
+     * @param aLength the total length of the telegram written.
+     */
+    void consumeSendCredit(uint8_t aLength);
+
+    /**
+     * Add a finished telegram to the send statistics.
+     * @param aAttempts the number of transmissions.
+     * @param aConfirmed true if the last one was confirmed.
+     */
+    void countSentTelegram(uint8_t aAttempts, bool aConfirmed);
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+    /**
+     * Write the next queued telegram if none is active and give up the active one after the confirmation timeout
+     * (see #getConfirmTimeout()).
+     */
+    void serviceSendQueue();
+
+    /**
+     * Finish the active queued telegram, call its callback and start the next one.
+     * A telegram that was not confirmed and has attempts left is kept and written again after its backoff.
+     * @param aResult the result of sending.
+     */
+    void completeQueuedTelegram(KnxTpUartSendResultType aResult);
+
+    /**
+     * Process received bytes until all queued telegrams were sent.
+     */
+    void flushSendQueue();
+
+    /**
+     * Put a copy of the telegram into a free send buffer and start sending if nothing is active.
+     * The caller checks that the queue is not full.
+     * @param aTelegram the telegram to send, the checksum must already be set.
+     * @param aCallback called once the telegram is finished, may be NULL.
+     * @param aContext a pointer passed to the callback unchanged.
+     * @param aFirst true to send it right after the active telegram, otherwise it goes behind the telegrams of the same or a higher priority.
+     */
+    void insertQueuedTelegram(KnxTelegram* aTelegram, KnxSendCallbackType aCallback, void* aContext, bool aFirst);
+#endif
+
+    /**
+     * Send a confirm message to the given address without waiting for its confirmation, as it is sent from
+     * #serialEvent(). With KNX_SUPPORT_TX_QUEUE it is queued ahead of all other telegrams, otherwise it is
+     * written at once and the receiver drops its confirmation.
      * @param aSequenceNo the sequence no of the telegram to confirm.
      * @param aAddress the source address of the telegram to confirm.
+     * @return false if the send queue is full, the sender then repeats its telegram.
      */
     bool sendNCDPosConfirm(uint8_t aSequenceNo, uint16_t aAddress);
 
     /**
-     * Read a single byte from serial interface with timeout.
-     * @return the read byte or -1 in case of timeout.
+     * Wait for the TP-UART to confirm the telegram just written.
+     * Received bytes are passed to the receiver meanwhile, so telegrams from the bus are not lost.
+     * @param aTotalLength the length of the telegram, see #getConfirmTimeout().
+     * @return TPUART_SEND_SUCCESS, TPUART_SEND_NOT_SUCCESS, TPUART_RESET_INDICATION_BYTE if the TP-UART reset itself
+     * or -1 if no byte arrived within the confirmation timeout.
+     */
+    int waitForConfirmation(uint8_t aTotalLength);
+
+    /**
+     * Wait at least the given time and until the governor allows a telegram to be written.
+     * Received bytes are passed to the receiver meanwhile.
+     * @param aDelayMs the minimum time to wait in ms, e.g. the backoff of a retransmission.
      */
-    int serialRead();
+    void waitBeforeSending(unsigned long aDelayMs);
 
 
 };
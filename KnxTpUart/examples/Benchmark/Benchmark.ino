@@ -0,0 +1,439 @@
+// File: Benchmark.ino
+// Micro benchmarks of the library building blocks.
+
+// Test constellation = any board, results are printed to Serial
+
+#include <KnxTpUart.h>
+
+// Number of operations per measurement
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 2000
+#endif
+
+#ifndef ARDUINO
+// Host build only: count heap allocations
+#include <new>
+unsigned long benchAllocations = 0;
+void* operator new(size_t size) {
+  benchAllocations++;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+void operator delete(void* p) noexcept {
+  free(p);
+}
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
+#endif
+
+// Print one result line: name, parameter, nanoseconds per operation
+void benchReport(const char* name, uint16_t param, unsigned long totalMicros, unsigned long ops) {
+  Serial.print(name);
+  Serial.print(", ");
+  Serial.print(param);
+  Serial.print(", ");
+  Serial.print(totalMicros * 1000UL / ops);
+  Serial.println(" ns/op");
+}
+
+// Print one result line: name, parameter, value with unit
+void benchReportValue(const char* name, uint16_t param, float value, const char* unit) {
+  Serial.print(name);
+  Serial.print(", ");
+  Serial.print(param);
+  Serial.print(", ");
+  Serial.print(value);
+  Serial.print(" ");
+  Serial.println(unit);
+}
+
+// The index-th test address, distinct for every index below 65536.
+// Scattered addresses spread over the whole range, clustered addresses come in blocks
+// of 8 consecutive sub groups like the objects of a multi channel actuator.
+uint16_t benchAddress(uint16_t index, bool clustered) {
+  if (clustered) {
+    return (uint16_t)(((index >> 3) * 40503U) << 3) | (index & 7);
+  }
+  return (uint16_t)(index * 40503U) ^ 0x5A5A;
+}
+
+// Memory and lookup cost of a listen table filled with count addresses, half of the lookups are hits
+template<typename T> void benchListenTable(const char* name, uint16_t count, bool clustered) {
+  T table;
+  for (uint16_t i = 0; i < count; i++) {
+    if (!table.add(benchAddress(i, clustered))) {
+      Serial.println("out of memory");
+      return;
+    }
+  }
+
+  uint16_t found = 0;
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    uint16_t index = (i >> 1) % count;
+    if (i & 1) {
+      // never added
+      index += count;
+    }
+    found += table.contains(benchAddress(index, clustered));
+  }
+  unsigned long duration = micros() - start;
+
+  benchReport(name, count, duration, BENCH_ITERATIONS);
+  benchReportValue(name, count, (float)table.getMemoryUsage() / count, "byte/GA");
+  if (found != BENCH_ITERATIONS / 2) {
+    Serial.println("unexpected: wrong number of hits");
+  }
+}
+
+void benchListenTables(bool clustered) {
+  Serial.print("# listen table lookup and memory, ");
+  Serial.print(clustered ? "clustered" : "scattered");
+  Serial.println(" addresses: table, addresses, result");
+#ifdef __AVR__
+  const uint16_t sizes[] = { 8, 32, 64, 128, 255 };
+#else
+  const uint16_t sizes[] = { 8, 32, 128, 255, 1000, 10000 };
+#endif
+  for (uint8_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    benchListenTable<KnxListenTableLinear>("linear", sizes[i], clustered);
+    benchListenTable<KnxListenTableSorted>("sorted", sizes[i], clustered);
+    benchListenTable<KnxListenTableRanges>("ranges", sizes[i], clustered);
+    benchListenTable<KnxListenTableHash>("hash", sizes[i], clustered);
+    benchListenTable<KnxListenTablePaged>("paged", sizes[i], clustered);
+#ifndef __AVR__
+    benchListenTable<KnxListenTableBitmap>("bitmap", sizes[i], clustered);
+#endif
+  }
+}
+
+// A port that plays the TP-UART: it counts the write calls and confirms every complete frame
+class ConfirmingStream : public Stream {
+  public:
+    unsigned long writeCalls;
+    unsigned long bytes;
+    uint8_t confirmations;
+
+    ConfirmingStream() {
+      writeCalls = 0;
+      bytes = 0;
+      confirmations = 0;
+    }
+
+    int available() {
+      return confirmations;
+    }
+
+    int read() {
+      if (confirmations == 0) {
+        return -1;
+      }
+      confirmations--;
+      return TPUART_SEND_SUCCESS;
+    }
+
+    int peek() {
+      return confirmations ? TPUART_SEND_SUCCESS : -1;
+    }
+
+    void flush() {
+    }
+
+    size_t write(uint8_t data) {
+      // a single byte write counts as call of its own
+      writeCalls++;
+      return count(&data, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+      writeCalls++;
+      return count(buffer, size);
+    }
+
+    using Print::write;
+
+  private:
+    size_t count(const uint8_t* buffer, size_t size) {
+      for (size_t i = 0; i < size; i++) {
+        // the control byte before the last telegram byte marks the end of the frame
+        if ((i & 1) == 0 && (buffer[i] & 0xC0) == TPUART_DATA_END) {
+          confirmations++;
+        }
+      }
+      bytes += size;
+      return size;
+    }
+};
+
+KnxTelegram benchTelegram(uint8_t payload) {
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 1));
+  tg.setTargetGroupAddress(KNX_GA(1, 2, 3));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  if (payload > 2) {
+    tg.set14ByteValue("benchmark text");
+  }
+  else {
+    tg.setFirstDataByte(1);
+  }
+  tg.createChecksum();
+  return tg;
+}
+
+// Encode time and number of port writes for short (9 byte) and long (23 byte) telegrams
+void benchSend() {
+  Serial.println("# telegram framing: name, telegram length, result");
+  const uint8_t payloads[] = { 2, 15 };
+  for (uint8_t p = 0; p < sizeof(payloads); p++) {
+    KnxTelegram tg = benchTelegram(payloads[p]);
+    uint8_t length = tg.getTotalLength();
+
+    uint8_t frame[TPUART_FRAME_MAX_SIZE];
+    uint16_t sum = 0;
+    unsigned long start = micros();
+    for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+      tg.setBufferByte(4, i);
+      sum += KnxTpUart::encodeTelegram(&tg, frame) + frame[9];
+    }
+    benchReport("encode", length, micros() - start, BENCH_ITERATIONS);
+    if (sum == 0) {
+      Serial.println("unexpected: nothing encoded");
+    }
+
+    tg.createChecksum();
+    ConfirmingStream port;
+    KnxTpUart knx(&port, KNX_IA(1, 1, 1));
+    // measure the CPU time, not the pacing of the bus load governor
+    knx.setBusLoadLimit(0, 0);
+    uint16_t sent = 0;
+    start = micros();
+    for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+      sent += knx.sendTelegram(&tg);
+    }
+    benchReport("send", length, micros() - start, BENCH_ITERATIONS);
+    benchReportValue("writes", length, (float)port.writeCalls / BENCH_ITERATIONS, "calls/telegram");
+    if (sent != BENCH_ITERATIONS || port.bytes != 2UL * length * BENCH_ITERATIONS) {
+      Serial.println("unexpected: telegrams not sent");
+    }
+  }
+}
+
+// Building a DPT-9 group write: the former way (checksum after the header and again after the value)
+// against the caller owned builder with a single checksum and a pre-encoded template,
+// then the whole helper including sending against sending the template
+void benchGroupWrite() {
+  Serial.println("# group write: name, telegram length, result");
+  ConfirmingStream port;
+  KnxTpUart knx(&port, KNX_IA(1, 1, 1));
+  knx.setBusLoadLimit(0, 0);
+  KnxTelegram tg;
+
+  uint16_t sum = 0;
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    tg.clear();
+    tg.setSourceAddress(KNX_IA(1, 1, 1));
+    tg.setTargetGroupAddress(KNX_GA(1, 2, 3));
+    tg.setCommand(KNX_COMMAND_WRITE);
+    tg.createChecksum();
+    tg.set2ByteFloatValue(0.01 * (i & 0x3FF));
+    tg.createChecksum();
+    sum += tg.getChecksum();
+  }
+  benchReport("build twice checksummed", tg.getTotalLength(), micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    knx.buildGroupTelegram(&tg, KNX_COMMAND_WRITE, KNX_GA(1, 2, 3));
+    tg.set2ByteFloatValue(0.01 * (i & 0x3FF));
+    tg.createChecksum();
+    sum += tg.getChecksum();
+  }
+  benchReport("buildGroupTelegram", tg.getTotalLength(), micros() - start, BENCH_ITERATIONS);
+
+  KnxTelegramTemplate temperature(&tg);
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    temperature.set2ByteFloatValue(0.01 * (i & 0x3FF));
+    sum += temperature.getFrame()[temperature.getFrameLength() - 1];
+  }
+  benchReport("template set2ByteFloatValue", tg.getTotalLength(), micros() - start, BENCH_ITERATIONS);
+  if (sum == 0) {
+    Serial.println("unexpected: nothing built");
+  }
+
+  unsigned long sent = 0;
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    sent += knx.groupWrite2ByteFloat(KNX_GA(1, 2, 3), 0.01 * (i & 0x3FF));
+  }
+  benchReport("groupWrite2ByteFloat", tg.getTotalLength(), micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    temperature.set2ByteFloatValue(0.01 * (i & 0x3FF));
+    sent += knx.sendTemplate(&temperature);
+  }
+  benchReport("sendTemplate", tg.getTotalLength(), micros() - start, BENCH_ITERATIONS);
+  if (sent != 2 * BENCH_ITERATIONS) {
+    Serial.println("unexpected: telegrams not sent");
+  }
+}
+
+// The floating point DPT-9 conversion the integer one replaced
+void floatEncode2ByteFloat(float value, uint8_t* data) {
+  float v = value * 100.0f;
+  int exponent = 0;
+  for (; v < -2048.0f; v /= 2) exponent++;
+  for (; v > 2047.0f; v /= 2) exponent++;
+  long m = lround(v) & 0x7FF;
+  short msb = (short) (exponent << 3 | m >> 8);
+  if (value < 0.0f) msb |= 0x80;
+  data[0] = msb;
+  data[1] = (uint8_t)m;
+}
+
+float floatDecode2ByteFloat(const uint8_t* data) {
+  int exponent = (data[0] & B01111000) >> 3;
+  int mantissa = ((data[0] & B00000111) << 8) | (data[1]);
+  if (data[0] & B10000000) {
+    return ((-2048 + mantissa) * 0.01) * pow(2.0, exponent);
+  }
+  return (mantissa * 0.01) * pow(2.0, exponent);
+}
+
+// DPT-9 conversion: the former float path against the integer codec, in hundredths and in float.
+// The encodings are spread over all exponents and signs.
+void benchDpt9() {
+  Serial.println("# dpt9: name, -, result");
+  uint8_t data[2];
+  float fsum = 0;
+  long lsum = 0;
+
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    data[0] = i * 40503U >> 8;
+    data[1] = i;
+    fsum += floatDecode2ByteFloat(data);
+  }
+  benchReport("float decode", 0, micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    data[0] = i * 40503U >> 8;
+    data[1] = i;
+    fsum += KnxDpt9::decode(data);
+  }
+  benchReport("KnxDpt9::decode", 0, micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    data[0] = i * 40503U >> 8;
+    data[1] = i;
+    lsum += KnxDpt9::decodeHundredths(data);
+  }
+  benchReport("KnxDpt9::decodeHundredths", 0, micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    floatEncode2ByteFloat(((int16_t)(i * 40503U)) * 10.07f, data);
+    lsum += data[1];
+  }
+  benchReport("float encode", 0, micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    KnxDpt9::encode(((int16_t)(i * 40503U)) * 10.07f, data);
+    lsum += data[1];
+  }
+  benchReport("KnxDpt9::encode", 0, micros() - start, BENCH_ITERATIONS);
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    KnxDpt9::encodeHundredths(((int16_t)(i * 40503U)) * 1007L, data);
+    lsum += data[1];
+  }
+  benchReport("KnxDpt9::encodeHundredths", 0, micros() - start, BENCH_ITERATIONS);
+
+  if (fsum == 0 && lsum == 0) {
+    Serial.println("unexpected: nothing converted");
+  }
+}
+
+// The String based group address parser that KnxAddress replaced
+uint16_t stringGroupAddress(String aAddress) {
+  const char aDelimiter = '/';
+  uint16_t addr = aAddress.substring(0, aAddress.indexOf(aDelimiter)).toInt();
+  addr = addr << 5;
+  addr |= aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).substring(0, aAddress.substring(aAddress.indexOf(aDelimiter) + 1, aAddress.length()).indexOf(aDelimiter)).toInt();
+  addr = addr << 3;
+  addr |= aAddress.substring(aAddress.lastIndexOf(aDelimiter) + 1, aAddress.length()).toInt();
+  return addr;
+}
+
+// Parsing "main/middle/sub": the former String parser against the single pass one,
+// the String argument of the former one is created once outside the measurement
+void benchAddressParsing() {
+  Serial.println("# address parsing: name, -, result");
+  const char* texts[] = { "1/2/3", "31/7/255", "0/0/1", "12/5/100" };
+  const uint16_t expected[] = { KnxAddress::group("1/2/3"), KnxAddress::group("31/7/255"),
+                                KnxAddress::group("0/0/1"), KnxAddress::group("12/5/100") };
+  String strings[] = { texts[0], texts[1], texts[2], texts[3] };
+  uint16_t sum = 0;
+  uint16_t errors = 0;
+
+  #ifndef ARDUINO
+    unsigned long allocations = benchAllocations;
+  #endif
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    sum += stringGroupAddress(strings[i & 3]);
+  }
+  benchReport("String parser", 0, micros() - start, BENCH_ITERATIONS);
+  #ifndef ARDUINO
+    benchReportValue("String parser", 0, (float)(benchAllocations - allocations) / BENCH_ITERATIONS, "allocations/op");
+    allocations = benchAllocations;
+  #endif
+
+  start = micros();
+  for (uint16_t i = 0; i < BENCH_ITERATIONS; i++) {
+    uint16_t address = 0;
+    KnxAddress::parseGroupAddress(texts[i & 3], &address);
+    errors += (address != expected[i & 3]);
+  }
+  benchReport("KnxAddress::parseGroupAddress", 0, micros() - start, BENCH_ITERATIONS);
+  #ifndef ARDUINO
+    benchReportValue("KnxAddress::parseGroupAddress", 0, (float)(benchAllocations - allocations) / BENCH_ITERATIONS, "allocations/op");
+  #endif
+
+  if (sum == 0 || errors != 0) {
+    Serial.println("unexpected: wrong address parsed");
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  benchListenTables(false);
+  benchListenTables(true);
+  benchSend();
+  benchGroupWrite();
+  benchDpt9();
+  benchAddressParsing();
+}
+
+void loop() {
+}
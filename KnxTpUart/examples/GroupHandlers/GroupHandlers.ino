@@ -0,0 +1,75 @@
+// File: GroupHandlers.ino
+// Receive telegrams through handlers bound to group addresses instead of one big if/else chain.
+
+// Test constellation = ARDUINO MEGA <-> 5WG1 117-2AB12
+
+#include <KnxTpUart.h>
+
+#ifndef KNX_SUPPORT_GROUP_HANDLERS
+#error "Uncomment KNX_SUPPORT_GROUP_HANDLERS in KnxTpUart.h for this example"
+#endif
+
+// Initialize the KNX TP-UART library on the Serial1 port of ARDUINO MEGA
+// and with KNX physical address 15.15.20
+KnxTpUart knx(&Serial1, KNX_IA(15,15,20));
+
+int LED = 13;
+
+// State of 8 switch channels, written by the channel GAs 15/1/0 ... 15/1/7
+bool channels[8];
+
+void onLed(KnxTelegram* telegram, void* context) {
+  if (telegram->getCommand() == KNX_COMMAND_WRITE) {
+    digitalWrite(LED, telegram->getBool() ? HIGH : LOW);
+  }
+}
+
+void onTemperature(KnxTelegram* telegram, void* context) {
+  if (telegram->getCommand() == KNX_COMMAND_WRITE) {
+    Serial.print("Temperature: ");
+    Serial.println(telegram->get2ByteFloatValue());
+  }
+}
+
+// one handler for the whole range, the channel is taken from the sub group
+void onChannel(KnxTelegram* telegram, void* context) {
+  bool* state = (bool*)context;
+  uint8_t channel = telegram->getTargetSubGroup();
+  if (telegram->getCommand() == KNX_COMMAND_WRITE) {
+    state[channel] = telegram->getBool();
+  }
+  else if (telegram->getCommand() == KNX_COMMAND_READ) {
+    knx.groupAnswerBool(telegram->getTargetGroupAddress(), state[channel]);
+  }
+}
+
+void setup() {
+  pinMode(LED, OUTPUT);
+  digitalWrite(LED, LOW);
+
+  Serial.begin(9600);
+  Serial.println("TP-UART Test");
+
+  Serial1.begin(19200, SERIAL_8E1);
+
+  knx.uartReset();
+
+  knx.addGroupHandler(KNX_GA(15,0,0), onLed);
+  knx.addGroupHandler(KNX_GA(15,0,5), onTemperature);
+  knx.addGroupHandler(KNX_GA(15,1,0), KNX_GA(15,1,7), onChannel, channels);
+}
+
+void loop() {
+  // nothing in the loop. This example is only to receive telegrams
+}
+
+void serialEvent1() {
+  KnxTpUartSerialEventType eType = knx.serialEvent();
+  if (eType == TPUART_RESET_INDICATION) {
+    Serial.println("Event TPUART_RESET_INDICATION");
+  }
+  else if (eType == KNX_TELEGRAM) {
+    // telegrams without a handler, e.g. to the own individual address
+    Serial.println("Event KNX_TELEGRAM");
+  }
+}
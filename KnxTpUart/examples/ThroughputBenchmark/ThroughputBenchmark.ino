@@ -0,0 +1,251 @@
+// File: ThroughputBenchmark.ino
+// End-to-end benchmark of the receive and send path: traffic mixes are replayed through KnxTpUart
+// against a simulated TP-UART (TrafficStream.h), the results are printed to Serial as one JSON object.
+
+// Test constellation = any board, results are printed to Serial
+
+#include <KnxTpUart.h>
+#include "TrafficStream.h"
+
+// Number of telegrams per traffic mix and direction
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES 100
+#endif
+
+// Time the simulated TP-UART takes to confirm a telegram, 0 measures the CPU time only
+#ifndef BENCH_CONFIRM_DELAY_US
+#define BENCH_CONFIRM_DELAY_US 0
+#endif
+
+#define BENCH_ADDRESS KNX_IA(1, 1, 1)
+
+// Group addresses 1/0/x are bound to a handler (if enabled), 2/0/x are listen addresses, 3/0/x are of no interest
+#define BENCH_HANDLER_GA(i) KNX_GA(1, 0, (i))
+#define BENCH_LISTEN_GA(i) KNX_GA(2, 0, (i))
+#define BENCH_LISTEN_GAS 8
+
+// Short group writes: DPT 1 switching, 9 byte telegrams, dispatched to a group handler
+void dpt1Traffic(uint16_t index, KnxTelegram* tg) {
+  tg->clear();
+  tg->setSourceAddress(KNX_IA(1, 1, 10));
+  tg->setTargetGroupAddress(BENCH_HANDLER_GA(index & 0xFF));
+  tg->setCommand(KNX_COMMAND_WRITE);
+  tg->set<KnxDpt1>(index & 1);
+  tg->createChecksum();
+}
+
+// Maximum length: DPT 16 text, 23 byte telegrams to listen addresses
+void longTraffic(uint16_t index, KnxTelegram* tg) {
+  tg->clear();
+  tg->setSourceAddress(KNX_IA(1, 1, 10));
+  tg->setTargetGroupAddress(BENCH_LISTEN_GA(index % BENCH_LISTEN_GAS));
+  tg->setCommand(KNX_COMMAND_WRITE);
+  tg->set<KnxDpt16>((index & 1) ? "Status: Alarm!" : "Status: normal");
+  tg->createChecksum();
+}
+
+// Mixed group and individual traffic, half of it is for other devices
+void mixedTraffic(uint16_t index, KnxTelegram* tg) {
+  tg->clear();
+  tg->setSourceAddress(KNX_IA(1, 1, 10));
+  switch (index & 3) {
+    case 0:
+      tg->setTargetGroupAddress(BENCH_HANDLER_GA(index & 0xFF));
+      tg->setCommand(KNX_COMMAND_WRITE);
+      tg->set<KnxDpt1>(true);
+      break;
+    case 1:
+      tg->setTargetGroupAddress(KNX_GA(3, 0, (index & 0xFF)));
+      tg->setCommand(KNX_COMMAND_WRITE);
+      tg->set<KnxDpt9>(21.5);
+      break;
+    case 2:
+      tg->setTargetIndividualAddress(BENCH_ADDRESS);
+      tg->setCommunicationType(KNX_COMM_NDP);
+      tg->setSequenceNumber(index & 0x0F);
+      tg->setCommand(KNX_COMMAND_MASK_VERSION_READ);
+      break;
+    default:
+      tg->setTargetIndividualAddress(KNX_IA(1, 1, 20));
+      tg->setCommunicationType(KNX_COMM_NDP);
+      tg->setSequenceNumber(index & 0x0F);
+      tg->setCommand(KNX_COMMAND_MASK_VERSION_READ);
+      break;
+  }
+  tg->createChecksum();
+}
+
+struct BenchMix {
+  const char* name;
+  TrafficGeneratorType generator;
+};
+
+const BenchMix benchMixes[] = {
+  { "dpt1", dpt1Traffic },
+  { "long", longTraffic },
+  { "mixed", mixedTraffic }
+};
+
+// Latencies of the current measurement in us, saturated at 65535
+uint16_t benchLatency[BENCH_FRAMES];
+uint16_t benchLatencyCount;
+
+// Telegrams delivered by serialEvent() so far, the index of the next one in the traffic
+uint16_t benchDelivered;
+
+void benchRecord(unsigned long latency) {
+  if (benchLatencyCount < BENCH_FRAMES) {
+    benchLatency[benchLatencyCount++] = (latency > 0xFFFF) ? 0xFFFF : latency;
+  }
+}
+
+// The application got the telegram: latency since its first byte was available
+void benchDeliver(TrafficStream* port) {
+  benchRecord(micros() - port->getReleaseTime(benchDelivered));
+  benchDelivered++;
+}
+
+void benchHandler(KnxTelegram* telegram, void* context) {
+  benchDeliver((TrafficStream*)context);
+}
+
+void benchPrintKey(const char* key) {
+  Serial.print("\"");
+  Serial.print(key);
+  Serial.print("\":");
+}
+
+void benchPrintValue(const char* key, unsigned long value) {
+  benchPrintKey(key);
+  Serial.print(value);
+  Serial.print(",");
+}
+
+// Print throughput, CPU time per telegram and the percentiles of the recorded latencies
+void benchPrintResults(uint16_t telegrams, unsigned long duration, const char* latencyKey) {
+  if (duration == 0) {
+    duration = 1;
+  }
+  benchPrintValue("telegrams", telegrams);
+  benchPrintValue("telegrams_per_s", (unsigned long)((float)telegrams * 1000000.0 / duration));
+  benchPrintKey("cpu_us_per_frame");
+  Serial.print((float)duration / telegrams);
+  Serial.print(",");
+
+  // insertion sort, the arrays are small on a MCU and it needs no extra memory
+  for (uint16_t i = 1; i < benchLatencyCount; i++) {
+    uint16_t value = benchLatency[i];
+    uint16_t j = i;
+    while (j > 0 && benchLatency[j - 1] > value) {
+      benchLatency[j] = benchLatency[j - 1];
+      j--;
+    }
+    benchLatency[j] = value;
+  }
+  benchPrintKey(latencyKey);
+  Serial.print("{");
+  if (benchLatencyCount > 0) {
+    benchPrintValue("p50", benchLatency[(benchLatencyCount - 1) * 50UL / 100]);
+    benchPrintValue("p99", benchLatency[(benchLatencyCount - 1) * 99UL / 100]);
+  }
+  benchPrintKey("samples");
+  Serial.print(benchLatencyCount);
+  Serial.print("}");
+}
+
+// Receive path: serialEvent() at saturation, the next telegram is available as soon as the previous one was read.
+// The time to generate the traffic is measured on its own and not counted as CPU time of the library.
+void benchReceive(const BenchMix* mix) {
+  TrafficStream port(BENCH_CONFIRM_DELAY_US);
+  KnxTpUart knx(&port, BENCH_ADDRESS);
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+  knx.addGroupHandler(BENCH_HANDLER_GA(0), BENCH_HANDLER_GA(255), benchHandler, &port);
+#else
+  // without handlers the same telegrams are evaluated in the loop
+  for (uint16_t i = 0; i <= 255; i++) {
+    knx.addListenGroupAddress(BENCH_HANDLER_GA(i));
+  }
+#endif
+  for (uint8_t i = 0; i < BENCH_LISTEN_GAS; i++) {
+    knx.addListenGroupAddress(BENCH_LISTEN_GA(i));
+  }
+
+  KnxTelegram tg;
+  unsigned long start = micros();
+  for (uint16_t i = 0; i < BENCH_FRAMES; i++) {
+    mix->generator(i, &tg);
+  }
+  unsigned long generation = micros() - start;
+
+  port.start(mix->generator, BENCH_FRAMES);
+  benchLatencyCount = 0;
+  benchDelivered = 0;
+  start = micros();
+  for (unsigned long polls = 0; benchDelivered < BENCH_FRAMES && polls < 64UL * BENCH_FRAMES; polls++) {
+    KnxTpUartSerialEventType event = knx.serialEvent();
+    if (event == KNX_TELEGRAM) {
+      benchDeliver(&port);
+    } else if (event == IRRELEVANT_KNX_TELEGRAM) {
+      // no application code runs for it, so there is no latency
+      benchDelivered++;
+    }
+  }
+  unsigned long duration = micros() - start;
+  duration = (duration > generation) ? duration - generation : 0;
+
+  Serial.print("\"rx\":{");
+  benchPrintValue("delivered", benchDelivered);
+  benchPrintValue("acks", port.acks);
+  benchPrintValue("nacks", port.nacks);
+  benchPrintResults(BENCH_FRAMES, duration, "latency_us");
+  Serial.print("}");
+}
+
+// Send path: blocking sendTelegram(), the latency is the time until the confirmation was read
+void benchTransmit(const BenchMix* mix) {
+  TrafficStream port(BENCH_CONFIRM_DELAY_US);
+  KnxTpUart knx(&port, BENCH_ADDRESS);
+  // measure the library, not the pacing of the bus load governor
+  knx.setBusLoadLimit(0, 0);
+
+  KnxTelegram tg;
+  uint16_t confirmed = 0;
+  unsigned long duration = 0;
+  benchLatencyCount = 0;
+  for (uint16_t i = 0; i < BENCH_FRAMES; i++) {
+    mix->generator(i, &tg);
+    unsigned long start = micros();
+    confirmed += knx.sendTelegram(&tg);
+    unsigned long latency = micros() - start;
+    duration += latency;
+    benchRecord(latency);
+  }
+
+  Serial.print("\"tx\":{");
+  benchPrintValue("confirmed", confirmed);
+  benchPrintResults(BENCH_FRAMES, duration, "confirm_latency_us");
+  Serial.print("}");
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.print("{\"benchmark\":\"throughput\",");
+  benchPrintValue("frames", BENCH_FRAMES);
+  benchPrintValue("confirm_delay_us", BENCH_CONFIRM_DELAY_US);
+  Serial.println("\"mixes\":[");
+  const uint8_t mixes = sizeof(benchMixes) / sizeof(benchMixes[0]);
+  for (uint8_t i = 0; i < mixes; i++) {
+    Serial.print("{\"mix\":\"");
+    Serial.print(benchMixes[i].name);
+    Serial.print("\",");
+    benchReceive(&benchMixes[i]);
+    Serial.print(",");
+    benchTransmit(&benchMixes[i]);
+    Serial.println((i + 1 < mixes) ? "}," : "}");
+  }
+  Serial.println("]}");
+}
+
+void loop() {
+}
@@ -0,0 +1,144 @@
+// File: TrafficStream.h
+// A Stream that plays a TP-UART under load for ThroughputBenchmark.ino.
+// Received telegrams are generated on the fly, so no traffic has to be kept in RAM.
+
+#ifndef TrafficStream_h
+#define TrafficStream_h
+
+#include <KnxTpUart.h>
+
+// Number of release times kept, a power of two larger than the telegrams the library can hold at once
+#define TRAFFIC_RELEASE_RING 8
+
+/**
+ * Fill the telegram with the given index of the traffic, including the checksum.
+ */
+typedef void (*TrafficGeneratorType)(uint16_t aIndex, KnxTelegram* aTelegram);
+
+/**
+ * Receive side: the telegrams of the generator are handed out one after the other, the next one
+ * becomes available as soon as the previous one was read completely, like a line at saturation.
+ * The time a telegram became available is kept to measure the latency of its delivery.
+ * Send side: every complete frame written is confirmed with TPUART_SEND_SUCCESS after the
+ * given confirmation delay, acknowledge information is counted.
+ */
+class TrafficStream : public Stream {
+  public:
+    unsigned long acks;
+    unsigned long nacks;
+    unsigned long confirmed;
+
+    TrafficStream(unsigned long aConfirmDelayUs = 0) {
+      mConfirmDelay = aConfirmDelayUs;
+      start(NULL, 0);
+    }
+
+    /**
+     * Start handing out aCount telegrams of the generator, NULL for no received traffic.
+     */
+    void start(TrafficGeneratorType aGenerator, uint16_t aCount) {
+      mGenerator = aGenerator;
+      mCount = aCount;
+      mReleased = 0;
+      mOffset = 0;
+      mLength = 0;
+      mConfirmations = 0;
+      acks = 0;
+      nacks = 0;
+      confirmed = 0;
+    }
+
+    /**
+     * @return the micros() the telegram with the given index became available, only valid for
+     * the last TRAFFIC_RELEASE_RING telegrams released.
+     */
+    unsigned long getReleaseTime(uint16_t aIndex) {
+      return mReleaseTimes[aIndex & (TRAFFIC_RELEASE_RING - 1)];
+    }
+
+    int available() {
+      if (mOffset < mLength) {
+        return mLength - mOffset;
+      }
+      if (isConfirmationReady()) {
+        return 1;
+      }
+      if (mReleased < mCount) {
+        // the previous telegram was read completely, the next one follows
+        KnxTelegram telegram;
+        mGenerator(mReleased, &telegram);
+        mLength = telegram.getTotalLength();
+        memcpy(mTelegram, telegram.getBuffer(), mLength);
+        mOffset = 0;
+        mReleaseTimes[mReleased & (TRAFFIC_RELEASE_RING - 1)] = micros();
+        mReleased++;
+        return mLength;
+      }
+      return 0;
+    }
+
+    int read() {
+      int data = peek();
+      if (mOffset < mLength) {
+        mOffset++;
+      } else if (data >= 0) {
+        mConfirmations--;
+        confirmed++;
+      }
+      return data;
+    }
+
+    int peek() {
+      if (available() == 0) {
+        return -1;
+      }
+      return (mOffset < mLength) ? mTelegram[mOffset] : TPUART_SEND_SUCCESS;
+    }
+
+    void flush() {
+    }
+
+    size_t write(uint8_t data) {
+      if (data == TPUART_ACK) {
+        acks++;
+      } else if (data == TPUART_NACK) {
+        nacks++;
+      }
+      return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+      for (size_t i = 0; i < size; i += 2) {
+        // the control byte before the last telegram byte marks the end of the frame
+        if ((buffer[i] & 0xC0) == TPUART_DATA_END) {
+          if (mConfirmations == 0) {
+            mConfirmTime = micros();
+          }
+          mConfirmations++;
+        }
+      }
+      return size;
+    }
+
+    using Print::write;
+
+  private:
+    TrafficGeneratorType mGenerator;
+    uint16_t mCount;
+    uint16_t mReleased;
+    unsigned long mReleaseTimes[TRAFFIC_RELEASE_RING];
+
+    uint8_t mTelegram[MAX_KNX_TELEGRAM_SIZE];
+    uint8_t mLength;
+    uint8_t mOffset;
+
+    unsigned long mConfirmDelay;
+    unsigned long mConfirmTime;
+    uint8_t mConfirmations;
+
+    bool isConfirmationReady() {
+      return mConfirmations > 0 && (micros() - mConfirmTime) >= mConfirmDelay;
+    }
+};
+
+#endif
@@ -0,0 +1,187 @@
+// File: ScriptedStream.h
+// A Stream used by the unit tests to play the role of the TP-UART.
+// Incoming bytes are scripted up front and released step by step,
+// outgoing bytes are captured for later inspection.
+
+#ifndef ScriptedStream_h
+#define ScriptedStream_h
+
+#include "Arduino.h"
+
+#define SCRIPTED_STREAM_SIZE 64
+
+class ScriptedStream : public Stream
+{
+  public:
+    ScriptedStream()
+    {
+        clear();
+    }
+
+    /**
+     * Drop all scripted and captured bytes.
+     */
+    void clear()
+    {
+        mScriptLength = 0;
+        mReadPos      = 0;
+        mReleasePos   = 0;
+        mWriteCount   = 0;
+        mWriteCalls   = 0;
+        mReleaseOnWrite = 0;
+    }
+
+    /**
+     * Append bytes to the script. They are not available before #release() is called.
+     */
+    void script(const uint8_t* aData, uint8_t aLength)
+    {
+        for (uint8_t i = 0; i < aLength && mScriptLength < SCRIPTED_STREAM_SIZE; i++)
+        {
+            mScript[mScriptLength++] = aData[i];
+        }
+    }
+
+    /**
+     * Append a single byte to the script.
+     */
+    void script(uint8_t aByte)
+    {
+        script(&aByte, 1);
+    }
+
+    /**
+     * Make the next aCount scripted bytes available for reading.
+     */
+    void release(uint8_t aCount)
+    {
+        mReleasePos += aCount;
+        if (mReleasePos > mScriptLength)
+        {
+            mReleasePos = mScriptLength;
+        }
+    }
+
+    /**
+     * Release the given number of scripted bytes after each buffer write, like the TP-UART
+     * answering a telegram with its confirmation.
+     */
+    void releaseOnWrite(uint8_t aCount)
+    {
+        mReleaseOnWrite = aCount;
+    }
+
+    /**
+     * Make all scripted bytes available for reading.
+     */
+    void releaseAll()
+    {
+        mReleasePos = mScriptLength;
+    }
+
+    int available()
+    {
+        return mReleasePos - mReadPos;
+    }
+
+    int read()
+    {
+        if (mReadPos >= mReleasePos)
+        {
+            return -1;
+        }
+        return mScript[mReadPos++];
+    }
+
+    int peek()
+    {
+        if (mReadPos >= mReleasePos)
+        {
+            return -1;
+        }
+        return mScript[mReadPos];
+    }
+
+    void flush()
+    {
+    }
+
+    size_t write(uint8_t aByte)
+    {
+        if (mWriteCount < SCRIPTED_STREAM_SIZE)
+        {
+            mWrittenAt[mWriteCount] = mReadPos;
+            mWritten[mWriteCount++] = aByte;
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t* aBuffer, size_t aSize)
+    {
+        mWriteCalls++;
+        for (size_t i = 0; i < aSize; i++)
+        {
+            write(aBuffer[i]);
+        }
+        release(mReleaseOnWrite);
+        return aSize;
+    }
+
+    using Print::write;
+
+    /**
+     * @return the number of calls of the buffer write function.
+     */
+    uint8_t getWriteCalls()
+    {
+        return mWriteCalls;
+    }
+
+    /**
+     * @return the number of bytes written to the stream.
+     */
+    uint8_t getWrittenCount()
+    {
+        return mWriteCount;
+    }
+
+    /**
+     * @return the written byte at the given index.
+     */
+    uint8_t getWrittenByte(uint8_t aIndex)
+    {
+        return mWritten[aIndex];
+    }
+
+    /**
+     * The stream position serves as simulated clock: every consumed byte is one tick.
+     * @return the number of scripted bytes consumed when the byte at the given index was written.
+     */
+    uint8_t getWrittenAt(uint8_t aIndex)
+    {
+        return mWrittenAt[aIndex];
+    }
+
+    /**
+     * Forget all captured bytes.
+     */
+    void clearWritten()
+    {
+        mWriteCount = 0;
+        mWriteCalls = 0;
+    }
+
+  private:
+    uint8_t mScript[SCRIPTED_STREAM_SIZE];
+    uint8_t mScriptLength;
+    uint8_t mReadPos;
+    uint8_t mReleasePos;
+    uint8_t mReleaseOnWrite;
+
+    uint8_t mWritten[SCRIPTED_STREAM_SIZE];
+    uint8_t mWrittenAt[SCRIPTED_STREAM_SIZE];
+    uint8_t mWriteCount;
+    uint8_t mWriteCalls;
+};
+
+#endif
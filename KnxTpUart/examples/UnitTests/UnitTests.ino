@@ -7,6 +7,7 @@
 
 #include <KnxTpUart.h>
 #include <ArduinoUnit.h>
+#include "ScriptedStream.h"
 
 TestSuite suite;
 KnxTpUart knx(&Serial1, KNX_IA(15,15,20));
@@ -30,7 +31,7 @@ test(knxTelegramClearAfterCreation) {
 }
 
 test(knxTelegramClear) {
-  knxTelegram->setBufferByte(1, 12345);
+  knxTelegram->setBufferByte(1, (uint8_t)12345);
   knxTelegram->clear();
 
   for (int i = 0; i < MAX_KNX_TELEGRAM_SIZE; i++) {
@@ -66,7 +67,7 @@ test(priorityProperty) {
 }
 
 test(sourceAddressProperties) {
-  knxTelegram->setSourceAddress(KNX_GA(15, 12, 20));
+  knxTelegram->setSourceAddress(KNX_IA(15, 12, 20));
   assertEquals(15, knxTelegram->getSourceArea());
   assertEquals(12, knxTelegram->getSourceLine());
   assertEquals(20, knxTelegram->getSourceMember()); 
@@ -111,18 +112,1368 @@ test(checksumProperty) {
   assertTrue(knxTelegram->verifyChecksum()); 
 }
 
+static_assert(KnxAddress::group("1/2/3") == KNX_GA(1, 2, 3), "group");
+static_assert(KnxAddress::group("31/7/255") == 0xFFFF, "group limits");
+static_assert(KnxAddress::individual("15.12.20") == KNX_IA(15, 12, 20), "individual");
+
+test(addressParsing) {
+  uint16_t address = 0;
+  assertEquals(KNX_ADDRESS_OK, KnxAddress::parseGroupAddress("1/2/3", &address));
+  assertEquals(KNX_GA(1, 2, 3), address);
+  assertEquals(KNX_ADDRESS_OK, KnxAddress::parseGroupAddress("31/07/255", &address));
+  assertEquals(KNX_GA(31, 7, 255), address);
+  assertEquals(KNX_ADDRESS_OK, KnxAddress::parseIndividualAddress("15.12.20", &address));
+  assertEquals(KNX_IA(15, 12, 20), address);
+
+  // errors leave the address unchanged
+  address = 0x1234;
+  assertEquals(KNX_ADDRESS_EMPTY, KnxAddress::parseGroupAddress("", &address));
+  assertEquals(KNX_ADDRESS_EMPTY, KnxAddress::parseGroupAddress(NULL, &address));
+  assertEquals(KNX_ADDRESS_INVALID_CHARACTER, KnxAddress::parseGroupAddress("1/2/3 ", &address));
+  assertEquals(KNX_ADDRESS_INVALID_CHARACTER, KnxAddress::parseGroupAddress("1.2.3", &address));
+  assertEquals(KNX_ADDRESS_MISSING_PART, KnxAddress::parseGroupAddress("1/2", &address));
+  assertEquals(KNX_ADDRESS_MISSING_PART, KnxAddress::parseGroupAddress("1//3", &address));
+  assertEquals(KNX_ADDRESS_MISSING_PART, KnxAddress::parseGroupAddress("1/2/", &address));
+  assertEquals(KNX_ADDRESS_TOO_MANY_PARTS, KnxAddress::parseGroupAddress("1/2/3/4", &address));
+  assertEquals(KNX_ADDRESS_OUT_OF_RANGE, KnxAddress::parseGroupAddress("32/0/0", &address));
+  assertEquals(KNX_ADDRESS_OUT_OF_RANGE, KnxAddress::parseGroupAddress("0/8/0", &address));
+  assertEquals(KNX_ADDRESS_OUT_OF_RANGE, KnxAddress::parseGroupAddress("0/0/99999", &address));
+  assertEquals(KNX_ADDRESS_OUT_OF_RANGE, KnxAddress::parseIndividualAddress("16.0.0", &address));
+  assertEquals(0x1234, address);
+
+  // the String based helpers use the same parser, an invalid text is address 0
+  assertEquals(KNX_GA(1, 2, 3), knx.getGroupAddress(String("1/2/3")));
+  assertEquals(KNX_GA(1, 2, 3), knx.getGroupAddress("1/2/3"));
+  assertEquals(KNX_IA(1, 1, 20), knx.getSourceAddress(String("1.1.20")));
+  assertEquals(0, knx.getGroupAddress("1/2/x"));
+  assertEquals(KnxAddress::group("1/2/3"), KNX_GA(1, 2, 3));
+}
+
 test(receivingGroupAddresses) {
   knx.addListenGroupAddress(KNX_GA(15, 15, 100));
   assertTrue(knx.isListeningToGroupAddress(KNX_GA(15, 15, 100)));
   assertTrue(! knx.isListeningToGroupAddress(KNX_GA(15, 3, 28)));
 }
 
+test(growingListenAddresses) {
+  ScriptedStream port;
+  KnxTpUart knx2(&port, KNX_IA(1, 1, 1));
+  assertTrue(knx2.setListenAddressCount(2));
+  for (uint16_t i = 0; i < 1000; i++) {
+    assertTrue(knx2.addListenGroupAddress(KNX_GA(4, 0, 0) + i));
+  }
+  // reserving again does not drop the added addresses
+  assertTrue(knx2.setListenAddressCount(10));
+  assertEquals(1000, knx2.getListenGroupAddressCount());
+  assertTrue(knx2.isListeningToGroupAddress(KNX_GA(4, 0, 0) + 999));
+  knx2.clearListenGroupAddresses();
+  assertTrue(!knx2.isListeningToGroupAddress(KNX_GA(4, 0, 0)));
+}
+
 test(floatValues) {
   knxTelegram->set2ByteFloatValue(25.28);
   assertEquals(4, knxTelegram->getPayloadLength());
   assertEquals(25.28 * 100.0, knxTelegram->get2ByteFloatValue() * 100); 
 }
 
+// The floating point DPT-9 conversion the integer one replaced, kept as reference
+void floatEncode2ByteFloat(float value, uint8_t* data) {
+  float v = value * 100.0f;
+  int exponent = 0;
+  for (; v < -2048.0f; v /= 2) exponent++;
+  for (; v > 2047.0f; v /= 2) exponent++;
+  long m = lround(v) & 0x7FF;
+  short msb = (short) (exponent << 3 | m >> 8);
+  if (value < 0.0f) msb |= 0x80;
+  data[0] = msb;
+  data[1] = (uint8_t)m;
+}
+
+float floatDecode2ByteFloat(const uint8_t* data) {
+  int exponent = (data[0] & B01111000) >> 3;
+  int mantissa = ((data[0] & B00000111) << 8) | (data[1]);
+  if (data[0] & B10000000) {
+    return ((-2048 + mantissa) * 0.01) * pow(2.0, exponent);
+  }
+  return (mantissa * 0.01) * pow(2.0, exponent);
+}
+
+test(dpt9AllEncodings) {
+  uint8_t raw[2];
+  uint8_t encoded[2];
+  uint8_t reference[2];
+  for (uint32_t i = 0; i < 0x10000; i++) {
+    raw[0] = i >> 8;
+    raw[1] = i;
+    float value = floatDecode2ByteFloat(raw);
+    int32_t hundredths = KnxDpt9::decodeHundredths(raw);
+
+    // same value as the float path
+    assertTrue(KnxDpt9::decode(raw) == value);
+
+    // the integer round trip keeps the value exactly
+    KnxDpt9::encodeHundredths(hundredths, encoded);
+    assertEquals(hundredths, KnxDpt9::decodeHundredths(encoded));
+
+    // encoding the float value gives the same value as the float path
+    KnxDpt9::encode(value, encoded);
+    floatEncode2ByteFloat(value, reference);
+    assertEquals(KnxDpt9::decodeHundredths(reference), KnxDpt9::decodeHundredths(encoded));
+    assertEquals(hundredths, KnxDpt9::decodeHundredths(encoded));
+  }
+}
+
+test(dpt9Hundredths) {
+  KnxTelegram tg;
+  tg.set2ByteFloatHundredths(2150);
+  assertEquals(0x0C, tg.getBufferByte(8));
+  assertEquals(0x33, tg.getBufferByte(9));
+  assertEquals(2150, tg.get2ByteFloatHundredths());
+  assertTrue(tg.get2ByteFloatValue() == 21.5);
+
+  // rounded half away from zero
+  tg.set2ByteFloatHundredths(4095);
+  assertEquals(4096, tg.get2ByteFloatHundredths());
+  tg.set2ByteFloatHundredths(-4095);
+  assertEquals(-4096, tg.get2ByteFloatHundredths());
+
+  // limits and clamping
+  tg.set2ByteFloatHundredths(-2048);
+  assertEquals(0x80, tg.getBufferByte(8));
+  assertEquals(0x00, tg.getBufferByte(9));
+  tg.set2ByteFloatHundredths(KNX_DPT9_MAX_HUNDREDTHS + 1000);
+  assertEquals(KNX_DPT9_MAX_HUNDREDTHS, tg.get2ByteFloatHundredths());
+  tg.set2ByteFloatValue(-1e9);
+  assertEquals(KNX_DPT9_MIN_HUNDREDTHS, tg.get2ByteFloatHundredths());
+
+  // a negative value that rounds to 0 is 0, not -20.48
+  tg.set2ByteFloatValue(-0.001);
+  assertEquals(0, tg.get2ByteFloatHundredths());
+}
+
+test(dptCodecs) {
+  KnxTelegram tg;
+
+  tg.set<KnxDpt1>(true);
+  assertEquals(2, tg.getPayloadLength());
+  assertEquals(1, tg.getFirstDataByte());
+  assertTrue(tg.getBool());
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.set<KnxDpt3>(B1101);
+  assertEquals(KNX_COMMAND_WRITE, tg.getCommand());
+  assertTrue(tg.get4BitDirectionValue());
+  assertEquals(5, tg.get4BitStepsValue());
+
+  tg.set<KnxDpt9>(25.28);
+  assertEquals(4, tg.getPayloadLength());
+  assertEquals(2528, tg.get2ByteFloatHundredths());
+  assertTrue(tg.get<KnxDpt9>() == tg.get2ByteFloatValue());
+
+  tg.set<KnxDpt6>(-100);
+  assertEquals(3, tg.getPayloadLength());
+  assertEquals(-100, tg.get1ByteIntValue());
+  tg.set<KnxDpt8>(-12345);
+  assertEquals(0xCF, tg.getBufferByte(8));
+  assertEquals(0xC7, tg.getBufferByte(9));
+  assertEquals(-12345, tg.get<KnxDpt8>());
+  tg.set<KnxDpt13>(-70000);
+  assertEquals(-70000, tg.get4ByteIntValue());
+  tg.set<KnxDpt12>(0xDEADBEEF);
+  assertEquals(0xDE, tg.getBufferByte(8));
+  assertEquals(0xEF, tg.getBufferByte(11));
+  assertTrue(tg.get4ByteUIntValue() == 0xDEADBEEF);
+  tg.set<KnxDpt14>(-1234.5);
+  assertEquals(0xC4, tg.getBufferByte(8));
+  assertTrue(tg.get4ByteFloatValue() == -1234.5);
+
+  KnxTime time = { 3, 23, 59, 30 };
+  tg.set<KnxDpt10>(time);
+  assertEquals(5, tg.getPayloadLength());
+  assertEquals(3, tg.get3ByteWeekdayValue());
+  assertEquals(23, tg.get3ByteHourValue());
+  assertEquals(30, tg.get<KnxDpt10>().second);
+  KnxDate date = { 31, 12, 99 };
+  tg.set<KnxDpt11>(date);
+  assertEquals(12, tg.get3ByteMonthValue());
+
+  tg.set<KnxDpt16>("KNX");
+  assertEquals(16, tg.getPayloadLength());
+  assertTrue(tg.get14ByteValue() == "KNX");
+
+  // a value of another size reads as 0
+  assertEquals(0, tg.get<KnxDpt7>());
+
+  // the shortcuts send the same telegram as the template
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setBusLoadLimit(0, 0);
+  port.releaseOnWrite(1);
+  port.script(TPUART_SEND_SUCCESS);
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(1, 2, 3), -21.5));
+  uint8_t written = port.getWrittenCount();
+  port.script(TPUART_SEND_SUCCESS);
+  assertTrue(tx.groupWrite<KnxDpt9>(KNX_GA(1, 2, 3), -21.5));
+  assertEquals(2 * written, port.getWrittenCount());
+  for (uint8_t i = 0; i < written; i++) {
+    assertEquals(port.getWrittenByte(i), port.getWrittenByte(written + i));
+  }
+}
+
+// Script a group write telegram from 1.1.2 into the given port
+uint8_t scriptGroupWrite(ScriptedStream* port, uint16_t ga, float value) {
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 2));
+  tg.setTargetGroupAddress(ga);
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.set2ByteFloatValue(value);
+  tg.createChecksum();
+  port->script(tg.getBuffer(), tg.getTotalLength());
+  return tg.getTotalLength();
+}
+
+test(incrementalReceive) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  rx.setListenAddressCount(1);
+  rx.addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  uint8_t len = scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+
+  // feed the telegram byte by byte, nothing is reported before it is complete
+  for (uint8_t i = 1; i < len; i++) {
+    port.release(1);
+    assertEquals(INCOMPLETE_KNX_TELEGRAM, rx.serialEvent());
+  }
+
+  port.release(1);
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, port.getWrittenCount());
+  assertEquals(TPUART_ACK, port.getWrittenByte(0));
+  assertEquals(KNX_GA(1, 2, 3), rx.getReceivedTelegram()->getTargetGroupAddress());
+  assertEquals(2150, (int)(rx.getReceivedTelegram()->get2ByteFloatValue() * 100));
+  assertEquals(0, port.available());
+}
+
+test(incrementalReceiveTimeout) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+  port.release(4);
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, rx.serialEvent());
+
+  delayMicroseconds(rx.getByteTimeout() + 2000);
+  assertEquals(TIMEOUT, rx.serialEvent());
+  assertEquals(1, port.getWrittenCount());
+  assertEquals(TPUART_RESET, port.getWrittenByte(0));
+}
+
+test(earlyAcknowledge) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  rx.setListenAddressCount(1);
+  rx.addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  // a long telegram, the whole frame is available at once
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 2));
+  tg.setTargetGroupAddress(KNX_GA(1, 2, 3));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.set14ByteValue("early ack test");
+  tg.createChecksum();
+  port.script(tg.getBuffer(), tg.getTotalLength());
+  port.releaseAll();
+
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, port.getWrittenCount());
+  assertEquals(TPUART_ACK, port.getWrittenByte(0));
+  // acknowledged right after the address type byte, before any payload byte was consumed
+  assertEquals(KNX_TELEGRAM_HEADER_SIZE, port.getWrittenAt(0));
+
+  // telegram to another group address is rejected at the same point
+  port.clear();
+  scriptGroupWrite(&port, KNX_GA(1, 2, 4), 1.0);
+  port.release(KNX_TELEGRAM_HEADER_SIZE);
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, port.getWrittenCount());
+  assertEquals(TPUART_NACK, port.getWrittenByte(0));
+  port.releaseAll();
+  assertEquals(IRRELEVANT_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, port.getWrittenCount());
+}
+
+// A captured group write of 21.5 (DPT-9) from 1.1.2 to 1/2/3, decoded at compile time
+constexpr uint8_t capturedFrame[] = { 0xBC, 0x11, 0x02, 0x0A, 0x03, 0xE3, 0x00, 0x80, 0x0C, 0x33, 0x05 };
+static_assert(KnxFrameView(capturedFrame).getTargetGroupAddress() == KNX_GA(1, 2, 3), "target");
+static_assert(KnxFrameView(capturedFrame).getSourceAddress() == KNX_IA(1, 1, 2), "source");
+static_assert(KnxFrameView(capturedFrame).getCommand() == KNX_COMMAND_WRITE, "command");
+static_assert(KnxFrameView(capturedFrame).getTotalLength() == 11, "length");
+
+test(frameView) {
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 2));
+  tg.setTargetGroupAddress(KNX_GA(1, 2, 3));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.setPriority(KNX_PRIORITY_ALARM);
+  tg.set2ByteFloatValue(21.5);
+  tg.createChecksum();
+
+  // every accessor agrees with the telegram
+  KnxFrameView frame(tg.getBuffer(), tg.getTotalLength());
+  assertTrue(frame.isValid());
+  assertEquals(tg.getPriority(), frame.getPriority());
+  assertEquals(tg.isRepeated(), frame.isRepeated());
+  assertEquals(tg.getSourceAddress(), frame.getSourceAddress());
+  assertEquals(tg.getSourceLine(), frame.getSourceLine());
+  assertTrue(frame.isTargetGroup());
+  assertEquals(tg.getTargetGroupAddress(), frame.getTargetGroupAddress());
+  assertEquals(tg.getTargetMiddleGroup(), frame.getTargetMiddleGroup());
+  assertEquals(tg.getRoutingCounter(), frame.getRoutingCounter());
+  assertEquals(tg.getPayloadLength(), frame.getPayloadLength());
+  assertEquals(tg.getTotalLength(), frame.getTotalLength());
+  assertEquals(tg.getCommand(), frame.getCommand());
+  assertEquals(tg.getChecksum(), frame.getChecksum());
+  assertTrue(frame.get<KnxDpt9>() == 21.5);
+  assertEquals(2150, frame.get<KnxDpt9Hundredths>());
+  assertEquals(0, frame.get<KnxDpt5>());
+
+  // the captured bytes with their checksum
+  uint8_t captured[sizeof(capturedFrame)];
+  memcpy(captured, capturedFrame, sizeof(captured));
+  assertTrue(KnxFrameView(captured, sizeof(captured)).isValid());
+  assertTrue(KnxFrameView(captured, sizeof(captured)).get<KnxDpt9>() == 21.5);
+
+  // a truncated or corrupted telegram is not valid, nothing is read behind the available bytes
+  assertTrue(!KnxFrameView(captured, 10).isValid());
+  assertEquals(0, KnxFrameView(captured, 9).get<KnxDpt9Hundredths>());
+  captured[9] ^= 1;
+  assertTrue(!KnxFrameView(captured, sizeof(captured)).isValid());
+
+  // the received telegram as view
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  rx.addListenGroupAddress(KNX_GA(1, 2, 3));
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+  port.releaseAll();
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  KnxFrameView received = rx.getReceivedFrame();
+  assertTrue(received.isValid());
+  assertTrue(received.getBuffer() == rx.getReceivedTelegram()->getBuffer());
+  assertEquals(2150, received.get<KnxDpt9Hundredths>());
+}
+
+test(receiveQueue) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  rx.setListenAddressCount(3);
+  rx.addListenGroupAddress(KNX_GA(1, 2, 3));
+  rx.addListenGroupAddress(KNX_GA(1, 2, 4));
+  rx.addListenGroupAddress(KNX_GA(1, 2, 5));
+
+  // a burst of three telegrams, handed out one per call in order
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 1.0);
+  scriptGroupWrite(&port, KNX_GA(1, 2, 4), 2.0);
+  scriptGroupWrite(&port, KNX_GA(1, 2, 5), 3.0);
+  port.releaseAll();
+
+  for (uint8_t i = 0; i < 3; i++) {
+    assertEquals(KNX_TELEGRAM, rx.serialEvent());
+    uint8_t sub = 3 + i;
+    assertEquals(KNX_GA(1, 2, sub), rx.getReceivedTelegram()->getTargetGroupAddress());
+  }
+  assertEquals(UNKNOWN, rx.serialEvent());
+  assertEquals(0, rx.getReceivedTelegramCount());
+  assertEquals(0, rx.getReceiveQueueOverflowCount());
+  assertEquals(3, port.getWrittenCount());
+
+  // sending does not touch the received telegram
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 4.0);
+  port.releaseAll();
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  KnxTelegram* received = rx.getReceivedTelegram();
+  rx.groupWrite2ByteFloat(KNX_GA(2, 2, 2), 5.0);
+  assertEquals(KNX_GA(1, 2, 3), received->getTargetGroupAddress());
+  assertEquals(400, (int)(received->get2ByteFloatValue() * 100));
+}
+
+#ifdef KNX_SUPPORT_GROUP_HANDLERS
+// Records the last telegram a group handler was called with
+struct HandlerRecord {
+  uint8_t calls;
+  uint16_t target;
+  float value;
+};
+
+void recordHandler(KnxTelegram* telegram, void* context) {
+  HandlerRecord* record = (HandlerRecord*)context;
+  record->calls++;
+  record->target = telegram->getTargetGroupAddress();
+  record->value = telegram->get2ByteFloatValue();
+}
+
+test(groupHandlers) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  HandlerRecord single = { 0, 0, 0 };
+  HandlerRecord range = { 0, 0, 0 };
+  assertTrue(rx.addGroupHandler(KNX_GA(1, 2, 3), recordHandler, &single));
+  assertTrue(rx.addGroupHandler(KNX_GA(2, 0, 0), KNX_GA(2, 0, 99), recordHandler, &range));
+  // overlapping ranges are rejected
+  assertTrue(!rx.addGroupHandler(KNX_GA(2, 0, 50), recordHandler, &single));
+
+  // bound addresses are acknowledged without a listening GA and dispatched
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 1.5);
+  scriptGroupWrite(&port, KNX_GA(2, 0, 42), 2.5);
+  scriptGroupWrite(&port, KNX_GA(2, 0, 100), 3.5);
+  port.releaseAll();
+
+  assertEquals(DISPATCHED_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, single.calls);
+  assertEquals(KNX_GA(1, 2, 3), single.target);
+  assertEquals(150, (int)(single.value * 100));
+  // the dispatched telegram is still available until the next serialEvent
+  assertEquals(KNX_GA(1, 2, 3), rx.getReceivedTelegram()->getTargetGroupAddress());
+
+  assertEquals(DISPATCHED_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, range.calls);
+  assertEquals(KNX_GA(2, 0, 42), range.target);
+
+  assertEquals(IRRELEVANT_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, single.calls);
+  assertEquals(1, range.calls);
+
+  assertEquals(3, port.getWrittenCount());
+  assertEquals(TPUART_ACK, port.getWrittenByte(0));
+  assertEquals(TPUART_ACK, port.getWrittenByte(1));
+  assertEquals(TPUART_NACK, port.getWrittenByte(2));
+
+  // after removal the range is neither acknowledged nor dispatched
+  assertTrue(rx.removeGroupHandler(KNX_GA(2, 0, 7)));
+  port.clear();
+  scriptGroupWrite(&port, KNX_GA(2, 0, 42), 2.5);
+  port.releaseAll();
+  assertEquals(IRRELEVANT_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(1, range.calls);
+
+#ifdef KNX_SUPPORT_LISTEN_GAS
+  // a listened GA without handler is reported, a handler bound to a listened GA (either order) still gets it
+  rx.addListenGroupAddress(KNX_GA(3, 0, 1));
+  rx.addListenGroupAddress(KNX_GA(3, 0, 2));
+  assertTrue(rx.addGroupHandler(KNX_GA(3, 0, 2), recordHandler, &range));
+  assertTrue(rx.addGroupHandler(KNX_GA(3, 0, 3), recordHandler, &single));
+  rx.addListenGroupAddress(KNX_GA(3, 0, 3));
+  port.clear();
+  scriptGroupWrite(&port, KNX_GA(3, 0, 1), 1.0);
+  scriptGroupWrite(&port, KNX_GA(3, 0, 2), 2.0);
+  scriptGroupWrite(&port, KNX_GA(3, 0, 3), 3.0);
+  port.releaseAll();
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(DISPATCHED_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(2, range.calls);
+  assertEquals(KNX_GA(3, 0, 2), range.target);
+  assertEquals(DISPATCHED_KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(2, single.calls);
+  assertEquals(KNX_GA(3, 0, 3), single.target);
+#endif
+}
+#endif
+
+// The target group address of the telegram written at the given offset (control and data byte interleaved)
+uint16_t writtenTarget(ScriptedStream* port, uint8_t offset) {
+  return (port->getWrittenByte(offset + 7) << 8) | port->getWrittenByte(offset + 9);
+}
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+// Records the results of queued telegrams in order of completion
+struct SendRecord {
+  uint8_t count;
+  uint16_t target[8];
+  KnxTpUartSendResultType result[8];
+};
+
+void recordSend(KnxTelegram* telegram, KnxTpUartSendResultType result, void* context) {
+  SendRecord* record = (SendRecord*)context;
+  record->target[record->count] = telegram->getTargetGroupAddress();
+  record->result[record->count++] = result;
+}
+
+void queueBoolWrite(KnxTpUart* tx, uint16_t ga, KnxPriorityType priority, SendRecord* record) {
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 1));
+  tg.setTargetGroupAddress(ga);
+  tg.setPriority(priority);
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.setFirstDataByte(1);
+  tg.createChecksum();
+  tx->queueTelegram(&tg, recordSend, record);
+}
+
+test(sendQueue) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setSendRetries(1, 0);
+  SendRecord record;
+  record.count = 0;
+
+  // the first telegram is written at once, the others are ordered by priority behind it
+  queueBoolWrite(&tx, KNX_GA(1, 0, 1), KNX_PRIORITY_NORMAL, &record);
+  queueBoolWrite(&tx, KNX_GA(1, 0, 2), KNX_PRIORITY_NORMAL, &record);
+  queueBoolWrite(&tx, KNX_GA(1, 0, 3), KNX_PRIORITY_ALARM, &record);
+  queueBoolWrite(&tx, KNX_GA(1, 0, 4), KNX_PRIORITY_SYSTEM, &record);
+  assertEquals(4, tx.getSendQueueCount());
+  assertEquals(18, port.getWrittenCount());
+  assertEquals(KNX_GA(1, 0, 1), writtenTarget(&port, 0));
+
+  KnxTelegram tg;
+  assertTrue(!tx.queueTelegram(&tg));
+
+  // each confirmation completes the active telegram and writes the next one
+  const uint16_t expected[] = { KNX_GA(1, 0, 4), KNX_GA(1, 0, 3), KNX_GA(1, 0, 2) };
+  for (uint8_t i = 0; i < 3; i++) {
+    port.clearWritten();
+    port.script(i == 1 ? TPUART_SEND_NOT_SUCCESS : TPUART_SEND_SUCCESS);
+    port.releaseAll();
+    tx.serialEvent();
+    assertEquals(i + 1, record.count);
+    assertEquals(18, port.getWrittenCount());
+    assertEquals(expected[i], writtenTarget(&port, 0));
+  }
+  assertEquals(KNX_GA(1, 0, 1), record.target[0]);
+  assertEquals(KNX_SEND_CONFIRMED, record.result[0]);
+  assertEquals(KNX_SEND_NOT_CONFIRMED, record.result[1]);
+
+  // without a confirmation the last one is given up after the timeout
+  port.clearWritten();
+  tx.serialEvent();
+  assertEquals(3, record.count);
+  delay(tx.getConfirmTimeout(9) / 1000 - 10);
+  tx.serialEvent();
+  assertEquals(3, record.count);
+  delay(12);
+  tx.serialEvent();
+  assertEquals(4, record.count);
+  assertEquals(KNX_GA(1, 0, 2), record.target[3]);
+  assertEquals(KNX_SEND_TIMEOUT, record.result[3]);
+  assertEquals(0, tx.getSendQueueCount());
+
+  // the TP-UART was reset, a late confirmation before its indication does not complete the next telegram
+  assertEquals(1, port.getWrittenCount());
+  assertEquals(TPUART_RESET, port.getWrittenByte(0));
+  queueBoolWrite(&tx, KNX_GA(1, 0, 5), KNX_PRIORITY_NORMAL, &record);
+  port.script(TPUART_SEND_SUCCESS);
+  port.script(TPUART_RESET_INDICATION_BYTE);
+  port.releaseAll();
+  assertEquals(TPUART_RESET_INDICATION, tx.serialEvent());
+  assertEquals(4, record.count);
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  tx.serialEvent();
+  assertEquals(5, record.count);
+  assertEquals(KNX_SEND_CONFIRMED, record.result[4]);
+  assertEquals(0, tx.getSendQueueCount());
+}
+
+test(queuedGroupWrite) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setQueuedSend(true);
+
+  // returns without a confirmation
+  assertTrue(tx.groupWriteBool(KNX_GA(1, 0, 1), true));
+  assertTrue(tx.groupWriteBool(KNX_GA(1, 0, 2), true));
+  assertEquals(2, tx.getSendQueueCount());
+  assertEquals(18, port.getWrittenCount());
+
+  port.script(TPUART_SEND_SUCCESS);
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  tx.serialEvent();
+  assertEquals(0, tx.getSendQueueCount());
+  assertEquals(36, port.getWrittenCount());
+  assertEquals(KNX_GA(1, 0, 2), writtenTarget(&port, 18));
+}
+#endif
+
+// True if the frame written at the given offset carries a valid checksum
+bool writtenChecksumValid(ScriptedStream* port, uint8_t offset, uint8_t length) {
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < length; i++) {
+    sum ^= port->getWrittenByte(offset + 2 * i + 1);
+  }
+  return sum == 0xFF;
+}
+
+test(sendRetries) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setSendRetries(3, 0);
+  tx.setBusLoadLimit(0, 0);
+
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 1));
+  tg.setTargetGroupAddress(KNX_GA(1, 0, 1));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.setFirstDataByte(1);
+  tg.createChecksum();
+
+  // the retransmission carries the repeat flag, the caller's telegram stays untouched
+  port.script(TPUART_SEND_NOT_SUCCESS);
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  assertTrue(tx.sendTelegram(&tg));
+  assertEquals(36, port.getWrittenCount());
+  assertEquals(tg.getBufferByte(0), port.getWrittenByte(1));
+  assertEquals(tg.getBufferByte(0) & ~B00100000, port.getWrittenByte(19));
+  assertTrue(writtenChecksumValid(&port, 0, 9));
+  assertTrue(writtenChecksumValid(&port, 18, 9));
+  assertTrue(!tg.isRepeated());
+
+  // given up after the last attempt
+  port.clear();
+  for (uint8_t i = 0; i < 3; i++) {
+    port.script(TPUART_SEND_NOT_SUCCESS);
+  }
+  port.releaseAll();
+  assertTrue(!tx.sendTelegram(&tg));
+  assertEquals(54, port.getWrittenCount());
+
+  const KnxTpUartSendStatistics* stats = tx.getSendStatistics();
+  assertEquals(2, stats->telegrams);
+  assertEquals(5, stats->attempts);
+  assertEquals(1, stats->failed);
+  assertEquals(0, stats->confirmedAfter[0]);
+  assertEquals(1, stats->confirmedAfter[1]);
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+  // a queued telegram waits for the backoff without blocking serialEvent()
+  tx.resetSendStatistics();
+  tx.setSendRetries(2, 20);
+  port.clear();
+  SendRecord record;
+  record.count = 0;
+  queueBoolWrite(&tx, KNX_GA(1, 0, 2), KNX_PRIORITY_NORMAL, &record);
+  port.script(TPUART_SEND_NOT_SUCCESS);
+  port.releaseAll();
+  tx.serialEvent();
+  assertEquals(0, record.count);
+  assertEquals(18, port.getWrittenCount());
+  delay(22);
+  tx.serialEvent();
+  assertEquals(36, port.getWrittenCount());
+  assertEquals(port.getWrittenByte(1) & ~B00100000, port.getWrittenByte(19));
+  assertTrue(writtenChecksumValid(&port, 18, 9));
+
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  tx.serialEvent();
+  assertEquals(1, record.count);
+  assertEquals(KNX_SEND_CONFIRMED, record.result[0]);
+  assertEquals(0, tx.getSendQueueCount());
+  assertEquals(1, stats->telegrams);
+  assertEquals(2, stats->attempts);
+  assertEquals(1, stats->confirmedAfter[1]);
+#endif
+}
+
+test(busLoadGovernor) {
+  // 9 byte telegram: 50 + 9 * 13 + 26 bit at 9600 baud
+  assertEquals(20104, KnxTpUart::getBusTime(9));
+  assertEquals(39062, KnxTpUart::getBusTime(23));
+
+  // 10 telegrams per second cost 100 ms each, the 250 ms burst credit takes three of them
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setBusLoadLimit(10, 0);
+#ifdef KNX_SUPPORT_TX_QUEUE
+  SendRecord record;
+  record.count = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    queueBoolWrite(&tx, KNX_GA(1, 0, i), KNX_PRIORITY_NORMAL, &record);
+  }
+  for (uint8_t i = 0; i < 3; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+    port.releaseAll();
+    tx.serialEvent();
+  }
+  assertEquals(3, record.count);
+  assertEquals(1, tx.getSendQueueCount());
+  assertEquals(54, port.getWrittenCount());
+
+  // the fourth one waits in the queue until 50 ms of credit are owed no longer
+  delay(40);
+  tx.serialEvent();
+  assertEquals(54, port.getWrittenCount());
+  delay(12);
+  tx.serialEvent();
+  assertEquals(64, port.getWrittenCount());
+
+  // a blocking send waits for the credit as well, 100 ms for the telegram written just before
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  tx.serialEvent();
+  assertEquals(0, tx.getSendQueueCount());
+  port.clear();
+  port.releaseOnWrite(1);
+  port.script(TPUART_SEND_SUCCESS);
+  unsigned long start = millis();
+  assertTrue(tx.groupWriteBool(KNX_GA(1, 0, 5), true));
+  assertTrue(millis() - start >= 90);
+  assertEquals(0, tx.getSendQueueCount());
+#else
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 4; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+  unsigned long start = millis();
+  for (uint8_t i = 0; i < 3; i++) {
+    assertTrue(tx.groupWriteBool(KNX_GA(1, 0, i), true));
+  }
+  assertTrue(millis() - start < 10);
+
+  // the fourth one waits until 50 ms of credit are owed no longer
+  assertTrue(tx.groupWriteBool(KNX_GA(1, 0, 3), true));
+  assertTrue(millis() - start >= 45);
+#endif
+
+  // the bus load limit charges long telegrams more: 39 ms at 50 % cost 78 ms, four fit into the burst
+  KnxTpUart load(&port, KNX_IA(1, 1, 1));
+  load.setBusLoadLimit(0, 50);
+  port.clear();
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 5; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+  start = millis();
+  for (uint8_t i = 0; i < 4; i++) {
+    assertTrue(load.groupWrite14ByteText(KNX_GA(1, 0, 6), "governor test"));
+  }
+  assertTrue(millis() - start < 10);
+  assertTrue(load.groupWrite14ByteText(KNX_GA(1, 0, 6), "governor test"));
+  assertTrue(millis() - start >= 60);
+
+  // without limits (the default) a burst is not slowed down
+  KnxTpUart unpaced(&port, KNX_IA(1, 1, 1));
+  port.clear();
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 20; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+  start = millis();
+  for (uint8_t i = 0; i < 20; i++) {
+    assertTrue(unpaced.groupWriteBool(KNX_GA(1, 0, 7), true));
+  }
+  assertTrue(millis() - start < 10);
+}
+
+// A clock that only advances when the library waits or the test moves it
+class VirtualClock : public KnxClock {
+  public:
+    unsigned long now;
+    unsigned long waits;
+
+    VirtualClock() {
+      now = 0;
+      waits = 0;
+    }
+
+    unsigned long getMicros() {
+      return now;
+    }
+
+    unsigned long getMillis() {
+      return now / 1000;
+    }
+
+    void wait(unsigned long aMaxUs) {
+      waits++;
+      now += aMaxUs;
+    }
+};
+
+test(injectedClock) {
+  VirtualClock clock;
+  ScriptedStream port;
+  KnxTpUart knx(&port, KNX_IA(1, 1, 1));
+  knx.setClock(&clock);
+  knx.setBusLoadLimit(0, 0);
+
+  // a stalled telegram is dropped one microsecond after the timeout
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+  port.release(4);
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, knx.serialEvent());
+  clock.now += knx.getByteTimeout();
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, knx.serialEvent());
+  clock.now++;
+  assertEquals(TIMEOUT, knx.serialEvent());
+
+  // a blocking send without confirmation gives up after exactly the timeout, waiting once
+  port.clear();
+  knx.setSendRetries(1, 0);
+  unsigned long start = clock.now;
+  assertTrue(!knx.groupWriteBool(KNX_GA(1, 2, 3), true));
+  assertEquals(knx.getConfirmTimeout(9) + 1, clock.now - start);
+  assertEquals(1UL, clock.waits);
+
+  // then the TP-UART is reset, a late confirmation before its indication is dropped
+  assertEquals(TPUART_RESET, port.getWrittenByte(port.getWrittenCount() - 1));
+  port.clear();
+  port.script(TPUART_SEND_SUCCESS);
+  port.script(TPUART_RESET_INDICATION_BYTE);
+  port.releaseAll();
+  assertEquals(TPUART_RESET_INDICATION, knx.serialEvent());
+
+  // the retry backoff is waited for in one go as well
+  port.clear();
+  port.releaseOnWrite(1);
+  port.script(TPUART_SEND_NOT_SUCCESS);
+  port.script(TPUART_SEND_SUCCESS);
+  knx.setSendRetries(2, 20);
+  clock.waits = 0;
+  start = clock.now;
+  assertTrue(knx.groupWriteBool(KNX_GA(1, 2, 3), true));
+  assertEquals(20000UL, clock.now - start);
+  assertEquals(1UL, clock.waits);
+}
+
+test(adaptiveTimeouts) {
+  VirtualClock clock;
+  ScriptedStream port;
+  KnxTpUart knx(&port, KNX_IA(1, 1, 1));
+  knx.setClock(&clock);
+  knx.setBusLoadLimit(0, 0);
+  knx.addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  // at 19200 baud the bus character of 1355 us is the byte time, at 4800 baud the host byte of 2292 us
+  assertEquals(1355UL + KNX_TIMEOUT_SLACK_US, knx.getByteTimeout());
+  // 19 bytes of 573 us to and from the TP-UART, 4 times 20104 us on the bus
+  assertEquals(19UL * 573 + 4UL * 20104 + KNX_TIMEOUT_SLACK_US, knx.getConfirmTimeout(9));
+  knx.setTimeouts(4800, 500);
+  assertEquals(2292UL + 500, knx.getByteTimeout());
+  knx.setTimeouts(KNX_HOST_BAUDRATE);
+
+  // bytes waiting in the UART are not overdue, however late the host looks at them
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+  port.release(4);
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, knx.serialEvent());
+  clock.now += 10 * knx.getByteTimeout();
+  port.releaseAll();
+  assertEquals(KNX_TELEGRAM, knx.serialEvent());
+
+  // every byte just in time, but the 11 byte telegram is not complete within 11 byte times and the slack
+  port.clear();
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 21.5);
+  for (uint8_t i = 0; i < 7; i++) {
+    port.release(1);
+    assertEquals(INCOMPLETE_KNX_TELEGRAM, knx.serialEvent());
+    clock.now += knx.getByteTimeout();
+  }
+  clock.now -= knx.getByteTimeout();
+  assertEquals(TIMEOUT, knx.serialEvent());
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+  // a queued telegram has the same deadline, it starts again with every byte received while it waits
+  port.clear();
+  knx.setSendRetries(1, 0);
+  SendRecord record;
+  record.count = 0;
+  queueBoolWrite(&knx, KNX_GA(1, 0, 1), KNX_PRIORITY_NORMAL, &record);
+  clock.now += knx.getConfirmTimeout(9) - 1000;
+  scriptGroupWrite(&port, KNX_GA(1, 2, 4), 1.0);
+  port.releaseAll();
+  assertEquals(IRRELEVANT_KNX_TELEGRAM, knx.serialEvent());
+  clock.now += knx.getConfirmTimeout(9);
+  knx.serialEvent();
+  assertEquals(0, record.count);
+  clock.now++;
+  knx.serialEvent();
+  assertEquals(1, record.count);
+  assertEquals(KNX_SEND_TIMEOUT, record.result[0]);
+#endif
+}
+
+#ifdef KNX_SUPPORT_SEND_FILTER
+test(sendFilter) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.setBusLoadLimit(0, 0);
+  tx.setSendRetries(1, 0);
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 16; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+
+  // absolute deadband of 0.5
+  assertTrue(tx.addSendFilter(KNX_GA(3, 0, 1), KNX_FILTER_2BYTE_FLOAT, 0.5));
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(3, 0, 1), 21.0));
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(3, 0, 1), 21.2));
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(3, 0, 1), 20.7));
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(3, 0, 1), 21.6));
+  assertEquals(2, port.getWriteCalls());
+
+  // relative deadband of 10 %
+  port.clearWritten();
+  assertTrue(tx.addSendFilter(KNX_GA(3, 0, 2), KNX_FILTER_1BYTE_UINT, 0, 10));
+  assertTrue(tx.groupWrite1ByteUInt(KNX_GA(3, 0, 2), 100));
+  assertTrue(tx.groupWrite1ByteUInt(KNX_GA(3, 0, 2), 109));
+  assertTrue(tx.groupWrite1ByteUInt(KNX_GA(3, 0, 2), 90));
+  assertEquals(2, port.getWriteCalls());
+
+  // send on change, answers and other addresses are not filtered
+  port.clearWritten();
+  assertTrue(tx.addSendFilter(KNX_GA(3, 0, 3), KNX_FILTER_RAW));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), false));
+  assertTrue(tx.groupAnswerBool(KNX_GA(3, 0, 3), false));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 4), false));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 4), false));
+  assertEquals(5, port.getWriteCalls());
+  assertEquals(4, tx.getSendStatistics()->suppressed);
+
+  // a write that was not confirmed is not remembered
+  port.clear();
+  assertTrue(!tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  port.clear();
+  port.script(TPUART_RESET_INDICATION_BYTE);
+  port.releaseAll();
+  assertEquals(TPUART_RESET_INDICATION, tx.serialEvent());
+  port.releaseOnWrite(1);
+  port.script(TPUART_SEND_SUCCESS);
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertEquals(1, port.getWriteCalls());
+
+#ifdef KNX_SUPPORT_TX_QUEUE
+  // queued writes report the suppression to their callback
+  SendRecord record;
+  record.count = 0;
+  queueBoolWrite(&tx, KNX_GA(3, 0, 3), KNX_PRIORITY_NORMAL, &record);
+  assertEquals(1, record.count);
+  assertEquals(KNX_SEND_SUPPRESSED, record.result[0]);
+  assertEquals(0, tx.getSendQueueCount());
+#endif
+
+  // the heartbeat sends an unchanged value again
+  port.clear();
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 3; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+  assertTrue(tx.addSendFilter(KNX_GA(3, 0, 3), KNX_FILTER_RAW, 0, 0, 1));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  delay(1002);
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertEquals(2, port.getWriteCalls());
+
+  assertTrue(tx.removeSendFilter(KNX_GA(3, 0, 3)));
+  assertTrue(!tx.removeSendFilter(KNX_GA(3, 0, 3)));
+  assertTrue(tx.groupWriteBool(KNX_GA(3, 0, 3), true));
+  assertEquals(3, port.getWriteCalls());
+}
+#endif
+
+test(telegramBuilder) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 7));
+  tx.setBusLoadLimit(0, 0);
+  port.releaseOnWrite(1);
+  for (uint8_t i = 0; i < 3; i++) {
+    port.script(TPUART_SEND_SUCCESS);
+  }
+
+  // built into a caller owned telegram, one checksum after the value is set
+  KnxTelegram tg;
+  tx.buildGroupTelegram(&tg, KNX_COMMAND_WRITE, KNX_GA(2, 3, 4));
+  tg.set2ByteFloatValue(21.5);
+  tg.createChecksum();
+  assertEquals(KNX_IA(1, 1, 7), tg.getSourceAddress());
+  assertEquals(KNX_GA(2, 3, 4), tg.getTargetGroupAddress());
+  assertEquals(KNX_COMMAND_WRITE, tg.getCommand());
+  assertEquals(2150, (int)(tg.get2ByteFloatValue() * 100));
+  assertTrue(tg.verifyChecksum());
+
+  // the same frame as the helper writes, sent from the telegram or its raw buffer
+  assertTrue(tx.groupWrite2ByteFloat(KNX_GA(2, 3, 4), 21.5));
+  assertTrue(tx.sendTelegram(&tg));
+  assertEquals(44, port.getWrittenCount());
+  for (uint8_t i = 0; i < 22; i++) {
+    assertEquals(port.getWrittenByte(i), port.getWrittenByte(22 + i));
+  }
+  port.clearWritten();
+  assertTrue(tx.sendTelegram(tg.getBuffer(), tg.getTotalLength()));
+  uint8_t frame[TPUART_FRAME_MAX_SIZE];
+  assertEquals(22, KnxTpUart::encodeTelegram(&tg, frame));
+  assertEquals(22, port.getWrittenCount());
+  for (uint8_t i = 0; i < 22; i++) {
+    assertEquals(frame[i], port.getWrittenByte(i));
+  }
+
+  // a raw buffer whose length does not match its header is refused
+  port.clearWritten();
+  assertTrue(!tx.sendTelegram(tg.getBuffer(), tg.getTotalLength() - 1));
+  assertEquals(0, port.getWrittenCount());
+
+  // individual telegrams
+  tx.buildIndividualTelegram(&tg, KNX_COMMAND_READ, KNX_IA(1, 1, 9));
+  tg.createChecksum();
+  assertTrue(!tg.isTargetGroup());
+  assertEquals(KNX_IA(1, 1, 9), tg.getTargetAddress());
+  assertTrue(tg.verifyChecksum());
+}
+
+// True if the template holds the same frame as the encoded telegram
+bool templateMatches(KnxTelegramTemplate* tmpl, KnxTelegram* tg) {
+  tg->createChecksum();
+  uint8_t frame[TPUART_FRAME_MAX_SIZE];
+  uint8_t length = KnxTpUart::encodeTelegram(tg, frame);
+  return length == tmpl->getFrameLength() && memcmp(frame, tmpl->getFrame(), length) == 0;
+}
+
+test(telegramTemplate) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  KnxTelegram tg;
+
+  // the incrementally updated checksum equals a full recalculation
+  tx.buildGroupTelegram(&tg, KNX_COMMAND_WRITE, KNX_GA(4, 0, 1));
+  tg.set2ByteFloatValue(0);
+  KnxTelegramTemplate temperature(&tg);
+  assertTrue(templateMatches(&temperature, &tg));
+  const float values[] = { 21.5, -3.25, 0, 670760, -0.01 };
+  for (uint8_t i = 0; i < 5; i++) {
+    temperature.set2ByteFloatValue(values[i]);
+    tg.set2ByteFloatValue(values[i]);
+    assertTrue(templateMatches(&temperature, &tg));
+  }
+
+  tx.buildGroupTelegram(&tg, KNX_COMMAND_WRITE, KNX_GA(4, 0, 2));
+  KnxTelegramTemplate flag(&tg);
+  flag.setBoolValue(true);
+  tg.setFirstDataByte(1);
+  assertTrue(templateMatches(&flag, &tg));
+
+  tx.buildGroupTelegram(&tg, KNX_COMMAND_ANSWER, KNX_GA(4, 0, 3));
+  tg.set4ByteFloatValue(0);
+  KnxTelegramTemplate power(&tg);
+  power.set4ByteFloatValue(1234.5);
+  tg.set4ByteFloatValue(1234.5);
+  assertTrue(templateMatches(&power, &tg));
+  power.set4ByteIntValue(-70000);
+  tg.set4ByteIntValue(-70000);
+  assertTrue(templateMatches(&power, &tg));
+
+  // the frame is written as it is, a retransmission leaves the template unchanged
+  tx.setBusLoadLimit(0, 0);
+  tx.setSendRetries(2, 0);
+  port.releaseOnWrite(1);
+  port.script(TPUART_SEND_NOT_SUCCESS);
+  port.script(TPUART_SEND_SUCCESS);
+  assertTrue(tx.sendTemplate(&power));
+  assertEquals(2 * power.getFrameLength(), port.getWrittenCount());
+  for (uint8_t i = 0; i < power.getFrameLength(); i++) {
+    assertEquals(power.getFrame()[i], port.getWrittenByte(i));
+  }
+  assertEquals(tg.getBufferByte(0) & ~B00100000, port.getWrittenByte(power.getFrameLength() + 1));
+  assertTrue(writtenChecksumValid(&port, power.getFrameLength(), power.getFrameLength() / 2));
+  assertTrue(templateMatches(&power, &tg));
+
+  KnxTelegramTemplate empty;
+  assertTrue(!tx.sendTemplate(&empty));
+
+  // the setters of a template that was not initialized do not touch the frame
+  empty.setBoolValue(true);
+  empty.setFirstDataByte(5);
+  empty.set2ByteFloatValue(21.5);
+  empty.set4ByteUIntValue(0x12345678UL);
+  assertEquals(0, empty.getFrameLength());
+  assertTrue(!tx.sendTemplate(&empty));
+}
+
+test(frameEncoding) {
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 1));
+  tg.setTargetGroupAddress(KNX_GA(1, 0, 1));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.setFirstDataByte(1);
+  tg.createChecksum();
+
+  uint8_t frame[TPUART_FRAME_MAX_SIZE];
+  assertEquals(18, KnxTpUart::encodeTelegram(&tg, frame));
+  for (uint8_t i = 0; i < 8; i++) {
+    assertEquals(TPUART_DATA_START_CONTINUE | i, frame[2 * i]);
+    assertEquals(tg.getBufferByte(i), frame[2 * i + 1]);
+  }
+  assertEquals(TPUART_DATA_END | 8, frame[16]);
+  assertEquals(tg.getBufferByte(8), frame[17]);
+
+  // the whole frame is handed to the port at once
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+  assertTrue(tx.sendTelegram(&tg));
+  assertEquals(1, port.getWriteCalls());
+  assertEquals(18, port.getWrittenCount());
+}
+
+test(receiveWhileSending) {
+  ScriptedStream port;
+  KnxTpUart tx(&port, KNX_IA(1, 1, 1));
+  tx.addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  // a telegram from the bus arrives before the confirmation of our own one
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 4.5);
+  port.script(TPUART_SEND_SUCCESS);
+  port.releaseAll();
+
+  assertTrue(tx.groupWriteBool(KNX_GA(5, 0, 1), true));
+  assertEquals(19, port.getWrittenCount());
+  assertEquals(TPUART_ACK, port.getWrittenByte(18));
+  assertEquals(0, port.available());
+
+  assertEquals(KNX_TELEGRAM, tx.serialEvent());
+  assertEquals(KNX_GA(1, 2, 3), tx.getReceivedTelegram()->getTargetGroupAddress());
+  assertEquals(450, (int)(tx.getReceivedTelegram()->get2ByteFloatValue() * 100));
+
+  // the TP-UART resets instead of confirming: the send fails at once without a reset of its own
+  port.clear();
+  scriptGroupWrite(&port, KNX_GA(1, 2, 3), 5.5);
+  port.script(TPUART_RESET_INDICATION_BYTE);
+  port.releaseAll();
+  unsigned long start = millis();
+  assertTrue(!tx.groupWriteBool(KNX_GA(5, 0, 1), true));
+  assertTrue(millis() - start < 10);
+  assertEquals(19, port.getWrittenCount());
+  assertEquals(0, port.available());
+
+  // and the sketch gets the reset behind the telegram received before it
+  assertEquals(KNX_TELEGRAM, tx.serialEvent());
+  assertEquals(550, (int)(tx.getReceivedTelegram()->get2ByteFloatValue() * 100));
+  assertEquals(TPUART_RESET_INDICATION, tx.serialEvent());
+  assertEquals(UNKNOWN, tx.serialEvent());
+}
+
+test(ncdConfirm) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 2));
+  tg.setTargetIndividualAddress(KNX_IA(1, 1, 1));
+  tg.setCommunicationType(KNX_COMM_NCD);
+  tg.setSequenceNumber(3);
+  tg.setCommand(KNX_COMMAND_READ);
+  tg.createChecksum();
+  port.script(tg.getBuffer(), tg.getTotalLength());
+  port.releaseAll();
+
+  // acknowledged and confirmed to the sender when handed out, without waiting for the TP-UART
+  unsigned long start = millis();
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertTrue(millis() - start < 10);
+  assertEquals(17, port.getWrittenCount());
+  assertEquals(TPUART_ACK, port.getWrittenByte(0));
+  assertEquals(KNX_IA(1, 1, 2), writtenTarget(&port, 1));
+
+  // its confirmation is not taken for the one of the next telegram
+  port.script(TPUART_SEND_SUCCESS);
+  port.script(TPUART_SEND_SUCCESS);
+  port.release(1);
+  port.releaseOnWrite(1);
+  assertTrue(rx.groupWriteBool(KNX_GA(1, 0, 1), true));
+  assertEquals(0, port.available());
+#ifdef KNX_SUPPORT_TX_QUEUE
+  assertEquals(0, rx.getSendQueueCount());
+#endif
+}
+
+// Shared checks for all listen table implementations
+template<typename T> bool checkListenTable(T* table) {
+  if (!table->setCapacity(10)) return false;
+  // insert in scrambled order including the edge addresses, more than reserved and more than 255
+  for (uint16_t i = 0; i < 298; i++) {
+    if (!table->add(KNX_GA(3, 1, 0) + (uint16_t)((i * 37) % 298) * 3)) return false;
+  }
+  if (!table->add(0x0000) || !table->add(0xFFFF)) return false;
+  if (!table->add(0x0000)) return false;  // duplicate is accepted
+  if (table->getCount() != 300) return false;
+
+  // reserving more keeps the added addresses
+  if (!table->setCapacity(400) || table->getCount() != 300) return false;
+
+  for (uint16_t i = 0; i < 298; i++) {
+    uint16_t ga = KNX_GA(3, 1, 0) + i * 3;
+    if (!table->contains(ga) || table->contains(ga + 1)) return false;
+  }
+  if (!table->contains(0x0000) || !table->contains(0xFFFF) || table->contains(KNX_GA(1, 1, 1))) return false;
+
+  table->clear();
+  return table->getCount() == 0 && !table->contains(0x0000) && table->add(KNX_GA(1, 1, 1)) && table->contains(KNX_GA(1, 1, 1));
+}
+
+test(listenTables) {
+  KnxListenTableLinear linear;
+  KnxListenTableSorted sorted;
+  KnxListenTableRanges ranges;
+  KnxListenTableHash hash;
+  assertTrue(!sorted.contains(KNX_GA(1, 1, 1)));
+  assertTrue(!ranges.contains(KNX_GA(1, 1, 1)));
+  assertTrue(!hash.contains(KNX_GA(1, 1, 1)));
+  // linear table stores duplicates, only check the others against the full list
+  assertTrue(linear.setCapacity(2) && linear.add(1) && linear.add(2) && linear.add(3));
+  assertTrue(linear.contains(3) && !linear.contains(4));
+  assertEquals(3, linear.getCount());
+  assertTrue(checkListenTable(&sorted));
+  assertTrue(checkListenTable(&ranges));
+  assertTrue(checkListenTable(&hash));
+}
+
+test(listenTableRanges) {
+  KnxListenTableRanges ranges;
+  // two blocks of sub groups are stored as two runs
+  assertTrue(ranges.addRange(KNX_GA(1, 0, 0), KNX_GA(1, 0, 99)));
+  assertTrue(ranges.addRange(KNX_GA(1, 0, 101), KNX_GA(1, 0, 200)));
+  assertEquals(200, ranges.getCount());
+  assertEquals(2, ranges.getRunCount());
+  assertTrue(!ranges.contains(KNX_GA(1, 0, 100)) && !ranges.contains(KNX_GA(1, 0, 201)));
+
+  // the gap joins the runs, extending at both ends works
+  assertTrue(ranges.add(KNX_GA(1, 0, 100)));
+  assertTrue(ranges.add(KNX_GA(1, 0, 201)));
+  assertTrue(ranges.add(KNX_GA(0, 7, 255)));
+  assertEquals(1, ranges.getRunCount());
+  assertEquals(203, ranges.getCount());
+  assertTrue(ranges.contains(KNX_GA(0, 7, 255)) && ranges.contains(KNX_GA(1, 0, 201)));
+  assertTrue(!ranges.contains(KNX_GA(0, 7, 254)) && !ranges.contains(KNX_GA(1, 0, 202)));
+  assertTrue(ranges.getMemoryUsage() <= 4 * sizeof(KnxListenRange));
+
+  // all addresses are a single run, the count stops at 0xFFFF
+  ranges.clear();
+  assertTrue(ranges.addRange(0x0000, 0xFFFF));
+  assertEquals(1, ranges.getRunCount());
+  assertEquals(0xFFFF, ranges.getCount());
+}
+
+// the bitmap tables have no capacity limit, check with more than 255 addresses
+template<typename T> bool checkBitmapListenTable(T* table) {
+  if (table->contains(KNX_GA(1, 1, 1))) return false;
+  for (uint16_t i = 0; i < 1000; i++) {
+    if (!table->add(KNX_GA(2, 0, 0) + i * 7)) return false;
+  }
+  if (!table->add(0x0000) || !table->add(0xFFFF) || !table->add(0xFFFF)) return false;
+  if (table->getCount() != 1002) return false;
+
+  for (uint16_t i = 0; i < 1000; i++) {
+    uint16_t ga = KNX_GA(2, 0, 0) + i * 7;
+    if (!table->contains(ga) || table->contains(ga + 1)) return false;
+  }
+  if (!table->contains(0x0000) || !table->contains(0xFFFF) || table->contains(KNX_GA(1, 1, 1))) return false;
+
+  // clearing drops all addresses
+  table->clear();
+  if (table->getCount() != 0 || table->contains(0x0000)) return false;
+
+  // the whole address space does not fit into the count, it stops at 0xFFFF instead of wrapping to 0
+  for (uint32_t ga = 0; ga <= 0xFFFF; ga++) {
+    if (!table->add(ga)) return false;
+  }
+  if (table->getCount() != 0xFFFF || !table->contains(0xFFFF)) return false;
+  table->clear();
+  return table->getCount() == 0;
+}
+
+test(bitmapListenTables) {
+  KnxListenTableBitmap bitmap;
+  KnxListenTablePaged paged;
+  assertTrue(checkBitmapListenTable(&bitmap));
+  assertTrue(checkBitmapListenTable(&paged));
+  assertEquals(0, paged.getPageCount());
+
+  // only the pages of used main/middle groups are allocated
+  assertTrue(paged.add(KNX_GA(1, 2, 3)) && paged.add(KNX_GA(1, 2, 200)) && paged.add(KNX_GA(4, 0, 1)));
+  assertEquals(2, paged.getPageCount());
+}
+
+test(ringBuffer) {
+  KnxRingBuffer<8> ring;
+  uint8_t buf[8];
+
+  assertEquals(0, ring.available());
+  assertEquals(-1, ring.read());
+
+  // fill completely, the next push must be rejected
+  for (uint8_t i = 0; i < 8; i++) {
+    assertTrue(ring.push(i));
+  }
+  assertTrue(!ring.push(8));
+  assertEquals(1, ring.getOverrunCount());
+  assertEquals(8, ring.available());
+
+  // partial bulk read followed by a wrap around
+  assertEquals(5, ring.read(buf, 5));
+  assertEquals(4, buf[4]);
+  for (uint8_t i = 8; i < 13; i++) {
+    assertTrue(ring.push(i));
+  }
+  assertEquals(5, ring.peek());
+  assertEquals(8, ring.read(buf, 8));
+  for (uint8_t i = 0; i < 8; i++) {
+    assertEquals(5 + i, buf[i]);
+  }
+  assertEquals(0, ring.available());
+
+  // the overrun count stops at 255 instead of wrapping to 0
+  for (uint16_t i = 0; i < 300; i++) {
+    ring.push(i);
+  }
+  assertEquals(255, ring.getOverrunCount());
+}
+
+#ifdef KNX_SUPPORT_RX_RING
+test(ringReceive) {
+  ScriptedStream port;
+  KnxTpUart rx(&port, KNX_IA(1, 1, 1));
+  rx.setListenAddressCount(2);
+  rx.addListenGroupAddress(KNX_GA(1, 2, 3));
+  rx.addListenGroupAddress(KNX_GA(1, 2, 4));
+
+  KnxTelegram tg;
+  tg.setSourceAddress(KNX_IA(1, 1, 2));
+  tg.setTargetGroupAddress(KNX_GA(1, 2, 3));
+  tg.setCommand(KNX_COMMAND_WRITE);
+  tg.set2ByteFloatValue(21.5);
+  tg.createChecksum();
+
+  // the bytes pushed by the interrupt are received like the ones of the Stream
+  uint8_t len = tg.getTotalLength();
+  for (uint8_t i = 0; i < len - 1; i++) {
+    assertTrue(rx.pushReceivedByte(tg.getBuffer()[i]));
+  }
+  assertEquals(INCOMPLETE_KNX_TELEGRAM, rx.serialEvent());
+  assertTrue(rx.pushReceivedByte(tg.getBuffer()[len - 1]));
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(TPUART_ACK, port.getWrittenByte(0));
+  assertEquals(KNX_GA(1, 2, 3), rx.getReceivedTelegram()->getTargetGroupAddress());
+
+  // the ring is read before the Stream
+  scriptGroupWrite(&port, KNX_GA(1, 2, 4), 1.0);
+  port.releaseAll();
+  for (uint8_t i = 0; i < len; i++) {
+    rx.pushReceivedByte(tg.getBuffer()[i]);
+  }
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(KNX_GA(1, 2, 3), rx.getReceivedTelegram()->getTargetGroupAddress());
+  assertEquals(KNX_TELEGRAM, rx.serialEvent());
+  assertEquals(KNX_GA(1, 2, 4), rx.getReceivedTelegram()->getTargetGroupAddress());
+
+  // bytes arriving at a full ring are lost and counted
+  assertEquals(0, rx.getReceiveOverrunCount());
+  for (uint8_t i = 0; i < KNX_RX_RING_SIZE + 2; i++) {
+    rx.pushReceivedByte(TPUART_RESET_INDICATION_BYTE);
+  }
+  assertEquals(2, rx.getReceiveOverrunCount());
+}
+#endif
 
 void loop() {
   suite.run();
@@ -0,0 +1,272 @@
+// File: Arduino.cpp
+// Minimal Arduino core for building and testing the library on a Linux host.
+
+#include "Arduino.h"
+
+#include <time.h>
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+// Time
+
+static uint64_t monotonicMicros()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+static const uint64_t sStart = monotonicMicros();
+
+static HostClock* sClock = NULL;
+
+void hostSetClock(HostClock* aClock)
+{
+    sClock = aClock;
+}
+
+static uint64_t currentMicros()
+{
+    return (sClock != NULL) ? sClock->getMicros() : monotonicMicros() - sStart;
+}
+
+unsigned long micros()
+{
+    return (unsigned long)currentMicros();
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(currentMicros() / 1000);
+}
+
+void delayMicroseconds(unsigned int aUs)
+{
+    if (sClock != NULL)
+    {
+        sClock->sleepMicros(aUs);
+        return;
+    }
+    struct timespec wait;
+    wait.tv_sec  = aUs / 1000000;
+    wait.tv_nsec = (long)(aUs % 1000000) * 1000;
+    nanosleep(&wait, NULL);
+}
+
+void delay(unsigned long aMs)
+{
+    if (sClock != NULL)
+    {
+        sClock->sleepMicros((uint64_t)aMs * 1000);
+        return;
+    }
+    struct timespec wait;
+    wait.tv_sec  = aMs / 1000;
+    wait.tv_nsec = (long)(aMs % 1000) * 1000000;
+    nanosleep(&wait, NULL);
+}
+
+void yield()
+{
+}
+
+// Pins
+
+static uint8_t sPins[256];
+
+void pinMode(uint8_t aPin, uint8_t aMode)
+{
+}
+
+void digitalWrite(uint8_t aPin, uint8_t aValue)
+{
+    sPins[aPin] = aValue ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t aPin)
+{
+    return sPins[aPin];
+}
+
+// String
+
+String::String(const char* aText)
+{
+    if (aText == NULL)
+    {
+        aText = "";
+    }
+    assign(aText, strlen(aText));
+}
+
+String::String(const String& aOther)
+{
+    assign(aOther.mBuffer, aOther.mLength);
+}
+
+String::String(int aValue)
+{
+    char text[12];
+    snprintf(text, sizeof(text), "%d", aValue);
+    assign(text, strlen(text));
+}
+
+String::~String()
+{
+    delete[] mBuffer;
+}
+
+String& String::operator=(const String& aOther)
+{
+    if (this != &aOther)
+    {
+        delete[] mBuffer;
+        assign(aOther.mBuffer, aOther.mLength);
+    }
+    return *this;
+}
+
+void String::assign(const char* aText, unsigned int aLength)
+{
+    mBuffer = new char[aLength + 1];
+    memcpy(mBuffer, aText, aLength);
+    mBuffer[aLength] = 0;
+    mLength = aLength;
+}
+
+int String::indexOf(char aChar) const
+{
+    const char* pos = strchr(mBuffer, aChar);
+    return pos != NULL ? (int)(pos - mBuffer) : -1;
+}
+
+int String::lastIndexOf(char aChar) const
+{
+    const char* pos = strrchr(mBuffer, aChar);
+    return pos != NULL ? (int)(pos - mBuffer) : -1;
+}
+
+String String::substring(unsigned int aFrom) const
+{
+    return substring(aFrom, mLength);
+}
+
+String String::substring(unsigned int aFrom, unsigned int aTo) const
+{
+    if (aFrom > aTo)
+    {
+        unsigned int swap = aFrom;
+        aFrom = aTo;
+        aTo = swap;
+    }
+    String result;
+    if (aFrom >= mLength)
+    {
+        return result;
+    }
+    if (aTo > mLength)
+    {
+        aTo = mLength;
+    }
+    delete[] result.mBuffer;
+    result.assign(mBuffer + aFrom, aTo - aFrom);
+    return result;
+}
+
+long String::toInt() const
+{
+    return atol(mBuffer);
+}
+
+void String::toCharArray(char* aBuffer, unsigned int aSize) const
+{
+    if (aSize == 0)
+    {
+        return;
+    }
+    unsigned int count = (mLength < aSize - 1) ? mLength : aSize - 1;
+    memcpy(aBuffer, mBuffer, count);
+    aBuffer[count] = 0;
+}
+
+// Print
+
+size_t Print::write(const uint8_t* aBuffer, size_t aSize)
+{
+    size_t count = 0;
+    while (aSize--)
+    {
+        count += write(*aBuffer++);
+    }
+    return count;
+}
+
+size_t Print::print(double aValue, int aDigits)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", aDigits, aValue);
+    return write(text);
+}
+
+size_t Print::printNumber(long long aValue, int aBase)
+{
+    char text[72];
+    if (aBase == HEX)
+    {
+        snprintf(text, sizeof(text), "%llX", (unsigned long long)aValue);
+    }
+    else if (aBase == BIN)
+    {
+        unsigned long long value = (unsigned long long)aValue;
+        char reversed[65];
+        uint8_t count = 0;
+        do
+        {
+            reversed[count++] = '0' + (value & 1);
+            value >>= 1;
+        } while (value != 0);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            text[i] = reversed[count - 1 - i];
+        }
+        text[count] = 0;
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%lld", aValue);
+    }
+    return write(text);
+}
+
+// Stream
+
+int Stream::timedRead()
+{
+    unsigned long start = millis();
+    do
+    {
+        int c = read();
+        if (c >= 0)
+        {
+            return c;
+        }
+        yield();
+    } while (millis() - start < mTimeout);
+    return -1;
+}
+
+size_t Stream::readBytes(uint8_t* aBuffer, size_t aSize)
+{
+    size_t count = 0;
+    while (count < aSize)
+    {
+        int c = timedRead();
+        if (c < 0)
+        {
+            break;
+        }
+        aBuffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
@@ -0,0 +1,187 @@
+// File: Arduino.h
+// Minimal Arduino core for building and testing the library on a Linux host, see CMakeLists.txt.
+// Only what the library, the unit tests and the benchmark use is provided.
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "binary.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define SERIAL_8N1 0x06
+#define SERIAL_8E1 0x26
+
+/**
+ * Host only: a replacement of the time base, e.g. the virtual clock of a simulation.
+ * millis(), micros(), delay() and delayMicroseconds() use it after hostSetClock().
+ */
+class HostClock
+{
+  public:
+    virtual ~HostClock() {}
+
+    /**
+     * @return the time in microseconds.
+     */
+    virtual uint64_t getMicros() = 0;
+
+    /**
+     * Let the given time pass.
+     */
+    virtual void sleepMicros(uint64_t aMicros) = 0;
+};
+
+/**
+ * Host only: use the given clock, NULL restores the monotonic clock of the system.
+ */
+void hostSetClock(HostClock* aClock);
+
+/**
+ * Milliseconds and microseconds since the program started (monotonic clock or the clock set by hostSetClock()).
+ */
+unsigned long millis();
+unsigned long micros();
+
+void delay(unsigned long aMs);
+void delayMicroseconds(unsigned int aUs);
+void yield();
+
+/**
+ * Pins are not connected on the host, the last written value is kept for tests.
+ */
+void pinMode(uint8_t aPin, uint8_t aMode);
+void digitalWrite(uint8_t aPin, uint8_t aValue);
+int digitalRead(uint8_t aPin);
+
+/**
+ * A heap allocated string like the one of the Arduino core: every non temporary String owns a buffer
+ * from the heap, so allocation counts on the host match the target.
+ */
+class String
+{
+  public:
+    String(const char* aText = "");
+    String(const String& aOther);
+    String(int aValue);
+    ~String();
+
+    String& operator=(const String& aOther);
+
+    unsigned int length() const { return mLength; }
+    const char* c_str() const { return mBuffer; }
+
+    int indexOf(char aChar) const;
+    int lastIndexOf(char aChar) const;
+    String substring(unsigned int aFrom) const;
+    String substring(unsigned int aFrom, unsigned int aTo) const;
+    long toInt() const;
+    void toCharArray(char* aBuffer, unsigned int aSize) const;
+
+    bool operator==(const String& aOther) const { return strcmp(mBuffer, aOther.mBuffer) == 0; }
+    bool operator==(const char* aOther) const { return strcmp(mBuffer, aOther) == 0; }
+    bool operator!=(const String& aOther) const { return !(*this == aOther); }
+
+  private:
+    void assign(const char* aText, unsigned int aLength);
+
+    char* mBuffer;
+    unsigned int mLength;
+};
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t aByte) = 0;
+    virtual size_t write(const uint8_t* aBuffer, size_t aSize);
+    size_t write(const char* aText) { return write((const uint8_t*)aText, strlen(aText)); }
+
+    size_t print(const char* aText) { return write(aText); }
+    size_t print(const String& aText) { return write(aText.c_str()); }
+    size_t print(char aChar) { return write((uint8_t)aChar); }
+    size_t print(unsigned char aValue, int aBase = DEC) { return printNumber(aValue, aBase); }
+    size_t print(int aValue, int aBase = DEC) { return printNumber(aValue, aBase); }
+    size_t print(unsigned int aValue, int aBase = DEC) { return printNumber(aValue, aBase); }
+    size_t print(long aValue, int aBase = DEC) { return printNumber(aValue, aBase); }
+    size_t print(unsigned long aValue, int aBase = DEC) { return printNumber(aValue, aBase); }
+    size_t print(double aValue, int aDigits = 2);
+
+    size_t println() { return write("\n"); }
+    template<typename T> size_t println(T aValue) { size_t n = print(aValue); return n + println(); }
+    template<typename T> size_t println(T aValue, int aFormat) { size_t n = print(aValue, aFormat); return n + println(); }
+
+  private:
+    size_t printNumber(long long aValue, int aBase);
+};
+
+class Stream : public Print
+{
+  public:
+    Stream() : mTimeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long aTimeout) { mTimeout = aTimeout; }
+
+    /**
+     * Read up to aSize bytes, waiting at most the timeout for each byte.
+     */
+    size_t readBytes(uint8_t* aBuffer, size_t aSize);
+    size_t readBytes(char* aBuffer, size_t aSize) { return readBytes((uint8_t*)aBuffer, aSize); }
+
+    using Print::write;
+
+  protected:
+    int timedRead();
+
+    unsigned long mTimeout;
+};
+
+/**
+ * Serial writes to stdout and never receives anything.
+ */
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long aBaud, uint8_t aConfig = SERIAL_8N1) {}
+    void end() {}
+
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+    void flush() { fflush(stdout); }
+
+    size_t write(uint8_t aByte) { return fputc(aByte, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,85 @@
+// File: ArduinoUnit.h
+// The subset of ArduinoUnit used by examples/UnitTests for running the tests on a Linux host.
+// TestSuite::run() runs all tests once, prints PASS or FAIL per test and exits with the number of failures.
+
+#ifndef ArduinoUnit_h
+#define ArduinoUnit_h
+
+#include "Arduino.h"
+
+class TestSuite
+{
+  public:
+    typedef void (*TestFunction)(bool& aPassed);
+
+    /**
+     * Called by the test() macro before main().
+     */
+    static void add(const char* aName, TestFunction aFunction)
+    {
+        Test* test = new Test;
+        test->name = aName;
+        test->function = aFunction;
+        test->next = 0;
+        Test** last = &first();
+        while (*last != 0)
+        {
+            last = &(*last)->next;
+        }
+        *last = test;
+    }
+
+    void run()
+    {
+        int passed = 0;
+        int failed = 0;
+        for (Test* test = first(); test != 0; test = test->next)
+        {
+            bool ok = true;
+            test->function(ok);
+            printf("%s %s\n", ok ? "PASS" : "FAIL", test->name);
+            ok ? passed++ : failed++;
+        }
+        printf("%d passed, %d failed\n", passed, failed);
+        exit(failed == 0 ? 0 : 1);
+    }
+
+  private:
+    struct Test
+    {
+        const char* name;
+        TestFunction function;
+        Test* next;
+    };
+
+    static Test*& first()
+    {
+        static Test* sFirst = 0;
+        return sFirst;
+    }
+};
+
+struct TestRegistration
+{
+    TestRegistration(const char* aName, TestSuite::TestFunction aFunction)
+    {
+        TestSuite::add(aName, aFunction);
+    }
+};
+
+#define test(name) \
+    static void test_##name(bool& _passed); \
+    static TestRegistration testRegistration_##name(#name, test_##name); \
+    static void test_##name(bool& _passed)
+
+#define assertTrue(condition) \
+    do { if (!(condition)) { \
+        printf("  %s:%d: assertTrue(%s) failed\n", __FILE__, __LINE__, #condition); \
+        _passed = false; return; } } while (0)
+
+#define assertEquals(expected, actual) \
+    do { if (!((expected) == (actual))) { \
+        printf("  %s:%d: assertEquals(%s, %s) failed\n", __FILE__, __LINE__, #expected, #actual); \
+        _passed = false; return; } } while (0)
+
+#endif
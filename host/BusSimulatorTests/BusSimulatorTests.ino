@@ -0,0 +1,383 @@
+// File: BusSimulatorTests.ino
+// Host only: tests of the simulated KNX line (host/KnxBusSimulator.h) with KnxTpUart instances as devices.
+// Built and run by CMake, see README.md.
+
+#include <KnxTpUart.h>
+#include <KnxBusSimulator.h>
+#include <ArduinoUnit.h>
+
+TestSuite suite;
+
+// A device on the simulated line: the library instance and what it received.
+struct SimDevice {
+  KnxTpUart* knx;
+  uint16_t received;
+  uint16_t repeated;
+  uint16_t lastAddress;
+  uint8_t resets;
+  uint8_t timeouts;
+  unsigned long timeoutAt;
+};
+
+void initDevice(SimDevice* device, KnxBusSimulator* bus, uint8_t index) {
+  device->knx = new KnxTpUart(bus->getPort(index), KNX_IA(1, 1, (index + 1)));
+  device->knx->setClock(bus->getPort(index));
+  device->received = 0;
+  device->repeated = 0;
+  device->lastAddress = 0;
+  device->resets = 0;
+  device->timeouts = 0;
+  device->timeoutAt = 0;
+}
+
+// The loop of a device: handle all events that are available.
+void pollDevice(void* context) {
+  SimDevice* device = (SimDevice*)context;
+  do {
+    KnxTpUartSerialEventType event = device->knx->serialEvent();
+    if (event == KNX_TELEGRAM) {
+      KnxTelegram* telegram = device->knx->getReceivedTelegram();
+      device->received++;
+      device->lastAddress = telegram->getTargetGroupAddress();
+      if (telegram->isRepeated()) {
+        device->repeated++;
+      }
+    } else if (event == TPUART_RESET_INDICATION) {
+      device->resets++;
+    } else if (event == TIMEOUT) {
+      device->timeouts++;
+      device->timeoutAt = micros();
+    }
+  } while (device->knx->getReceivedTelegramCount() > 0);
+}
+
+// Bus monitor: senders in order of the frames
+uint8_t monitorSenders[16];
+uint8_t monitorFrames;
+
+void recordSender(const uint8_t* frame, uint8_t length, uint8_t sender, bool acknowledged, void* context) {
+  if (monitorFrames < sizeof(monitorSenders)) {
+    monitorSenders[monitorFrames] = sender;
+  }
+  monitorFrames++;
+}
+
+void writeSwitch(void* context) {
+  SimDevice* device = (SimDevice*)context;
+  device->knx->groupWriteBool(KNX_GA(1, 2, 3), true);
+}
+
+void writeAlarm(void* context) {
+  SimDevice* device = (SimDevice*)context;
+  KnxTelegram telegram;
+  device->knx->buildGroupTelegram(&telegram, KNX_COMMAND_WRITE, KNX_GA(1, 2, 4), 1);
+  telegram.setPriority(KNX_PRIORITY_ALARM);
+  telegram.createChecksum();
+  device->knx->queueTelegram(&telegram);
+}
+
+void resetUart(void* context) {
+  SimDevice* device = (SimDevice*)context;
+  device->knx->uartReset();
+}
+
+test(simulatorFrameTiming) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 1000);
+  }
+  devices[0].knx->setQueuedSend(true);
+  devices[1].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  bus.schedule(1000, 0, writeSwitch, &devices[0]);
+  bus.run(100000);
+
+  // 9 byte telegram: 13 bits per character, acknowledge gap and character
+  const KnxBusSimulatorStatistics* stats = bus.getStatistics();
+  assertEquals(1UL, (unsigned long)stats->frames);
+  assertEquals(1UL, (unsigned long)stats->acknowledged);
+  assertEquals(KnxBusSimulator::getBitTime(13 * 9 + 15 + 11), stats->busyMicros);
+  assertEquals(1UL, (unsigned long)bus.getPort(0)->getConfirmedCount());
+  assertEquals(1, devices[1].received);
+  assertEquals(KNX_GA(1, 2, 3), devices[1].lastAddress);
+  assertEquals(0, devices[0].knx->getSendQueueCount());
+  assertEquals(0UL, (unsigned long)stats->lateAcks);
+}
+
+test(simulatorArbitration) {
+  KnxBusSimulator bus(4);
+  SimDevice devices[4];
+  for (uint8_t i = 0; i < 4; i++) {
+    initDevice(&devices[i], &bus, i);
+    devices[i].knx->setQueuedSend(true);
+    bus.setPoll(i, pollDevice, &devices[i], 1000);
+  }
+  devices[3].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+  devices[3].knx->addListenGroupAddress(KNX_GA(1, 2, 4));
+  monitorFrames = 0;
+  bus.setMonitor(recordSender, NULL);
+
+  // both are ready while the first frame is on the bus and compete for the next start:
+  // the alarm priority wins, then the lower source address
+  bus.schedule(1000, 2, writeSwitch, &devices[2]);
+  bus.schedule(2000, 1, writeSwitch, &devices[1]);
+  bus.schedule(2000, 0, writeAlarm, &devices[0]);
+  bus.schedule(2000, 2, writeSwitch, &devices[2]);
+  bus.run(500000);
+
+  // device 2 only hands its second telegram over after the first one was confirmed
+  assertEquals(4, monitorFrames);
+  assertEquals(2, monitorSenders[0]);
+  assertEquals(0, monitorSenders[1]);
+  assertEquals(1, monitorSenders[2]);
+  assertEquals(2, monitorSenders[3]);
+  assertEquals(2UL, (unsigned long)bus.getStatistics()->collisions);
+  assertEquals(4, devices[3].received);
+}
+
+test(simulatorRepeatWithoutAck) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 1000);
+  }
+  devices[0].knx->setQueuedSend(true);
+  devices[0].knx->setSendRetries(1, 0);
+
+  // nobody listens: sent once and repeated 3 times by the TP-UART, then reported as failed
+  bus.schedule(1000, 0, writeSwitch, &devices[0]);
+  bus.run(1000000);
+
+  const KnxBusSimulatorStatistics* stats = bus.getStatistics();
+  assertEquals(4UL, (unsigned long)stats->frames);
+  assertEquals(3UL, (unsigned long)stats->repetitions);
+  assertEquals(0UL, (unsigned long)stats->acknowledged);
+  assertEquals(1UL, (unsigned long)bus.getPort(0)->getFailedCount());
+  assertEquals(1UL, (unsigned long)devices[0].knx->getSendStatistics()->failed);
+  assertEquals(0, devices[1].received);
+}
+
+test(simulatorLostAcks) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 1000);
+  }
+  devices[0].knx->setQueuedSend(true);
+  devices[0].knx->setSendRetries(1, 0);
+  devices[1].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+  bus.setAckLossRate(100);
+
+  // the receiver gets the original and all repetitions, the repetitions carry the repeat flag
+  bus.schedule(1000, 0, writeSwitch, &devices[0]);
+  bus.run(1000000);
+
+  assertEquals(4UL, (unsigned long)bus.getStatistics()->lostAcks);
+  assertEquals(4, devices[1].received);
+  assertEquals(3, devices[1].repeated);
+}
+
+test(simulatorResetIndication) {
+  KnxBusSimulator bus(1);
+  SimDevice device;
+  initDevice(&device, &bus, 0);
+  bus.setPoll(0, pollDevice, &device);
+
+  bus.schedule(1000, 0, resetUart, &device);
+  bus.run(10000);
+  assertEquals(1, device.resets);
+}
+
+bool blockingResult;
+
+void writeSwitchBlocking(void* context) {
+  SimDevice* device = (SimDevice*)context;
+  blockingResult = device->knx->groupWriteBool(KNX_GA(1, 2, 3), true);
+}
+
+test(simulatorBlockingSend) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 1000);
+  }
+  devices[1].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+
+  // the confirmation comes after the frame went to the TP-UART and over the bus, the send waits for it
+  blockingResult = false;
+  bus.schedule(1000, 0, writeSwitchBlocking, &devices[0]);
+  bus.run(1000000);
+  assertTrue(blockingResult);
+  assertEquals(1UL, (unsigned long)bus.getStatistics()->frames);
+  assertEquals(1UL, (unsigned long)devices[0].knx->getSendStatistics()->confirmedAfter[0]);
+  assertEquals(1, devices[1].received);
+}
+
+test(simulatorTruncatedFrame) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 100);
+  }
+  devices[0].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+  devices[1].knx->setQueuedSend(true);
+
+  // the first 6 bytes of a telegram, then the line falls silent
+  KnxTelegram telegram;
+  devices[1].knx->buildGroupTelegram(&telegram, KNX_COMMAND_WRITE, KNX_GA(1, 2, 3), 1);
+  telegram.createChecksum();
+  bus.run(1000);
+  bus.injectReceived(0, telegram.getBuffer(), 6);
+  uint64_t lastByte = bus.getTime() + KnxBusSimulator::getBitTime(KNX_SIM_CHAR_BITS * 6) + bus.getHostByteTime();
+  bus.schedule(lastByte + 50000, 1, writeSwitch, &devices[1]);
+  bus.run(200000);
+
+  // dropped once the next byte is overdue (checked every 100 us), the telegram after it is received again
+  unsigned long recovery = devices[0].timeoutAt - lastByte;
+  assertTrue(recovery <= devices[0].knx->getByteTimeout() + 100);
+  assertEquals(1, devices[0].timeouts);
+  assertEquals(1, devices[0].resets);
+  assertEquals(1, devices[0].received);
+}
+
+test(simulatorSlowHost) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 100000);
+  }
+  devices[0].knx->addListenGroupAddress(KNX_GA(1, 2, 3));
+  devices[1].knx->setQueuedSend(true);
+
+  // the host looks at its UART only 9.5 ms after bytes arrived: the bytes wait in the buffer, but none is lost
+  bus.setPollLatency(9500);
+  for (uint8_t i = 0; i < 3; i++) {
+    bus.schedule(1000 + 200000UL * i, 1, writeSwitch, &devices[1]);
+  }
+  bus.run(1000000);
+  assertEquals(0, devices[0].timeouts);
+  assertTrue(devices[0].received >= 3);
+}
+
+test(simulatorIdleHour) {
+  KnxBusSimulator bus(2);
+  SimDevice devices[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    initDevice(&devices[i], &bus, i);
+    bus.setPoll(i, pollDevice, &devices[i], 60000000UL);
+  }
+  unsigned long start = millis();
+  bus.run(3600000000ULL);
+  assertTrue(millis() - start >= 3600000UL);
+  assertEquals(0UL, (unsigned long)bus.getStatistics()->frames);
+}
+
+// Scene recall: device 0 recalls a scene, the 99 actuators answer with their status at once
+#define SCENE_DEVICES 100
+#define SCENE_GA KNX_GA(1, 0, 0)
+
+struct SceneDevice {
+  KnxTpUart* knx;
+  uint8_t index;
+  bool recalled;
+};
+
+uint8_t sceneStatusCount[SCENE_DEVICES];
+uint32_t sceneTraceHash;
+
+void pollSceneDevice(void* context) {
+  SceneDevice* device = (SceneDevice*)context;
+  do {
+    if (device->knx->serialEvent() == KNX_TELEGRAM) {
+      uint16_t address = device->knx->getReceivedTelegram()->getTargetGroupAddress();
+      if (device->index == 0) {
+        sceneStatusCount[address & 0xFF]++;
+      } else if (address == SCENE_GA && !device->recalled) {
+        device->recalled = true;
+        device->knx->groupWriteBool(KNX_GA(2, 0, device->index), true);
+      }
+    }
+  } while (device->knx->getReceivedTelegramCount() > 0);
+}
+
+void recallScene(void* context) {
+  SceneDevice* device = (SceneDevice*)context;
+  device->knx->groupWrite1ByteUInt(SCENE_GA, 7);
+}
+
+void hashFrame(const uint8_t* frame, uint8_t length, uint8_t sender, bool acknowledged, void* context) {
+  sceneTraceHash = (sceneTraceHash ^ sender) * 16777619UL;
+  for (uint8_t i = 0; i < length; i++) {
+    sceneTraceHash = (sceneTraceHash ^ frame[i]) * 16777619UL;
+  }
+}
+
+// Run the scene recall, return the number of actuators whose status arrived exactly once at device 0
+uint8_t runSceneRecall(KnxBusSimulatorStatistics* stats) {
+  KnxBusSimulator bus(SCENE_DEVICES);
+  SceneDevice devices[SCENE_DEVICES];
+  for (uint8_t i = 0; i < SCENE_DEVICES; i++) {
+    devices[i].knx = new KnxTpUart(bus.getPort(i), KNX_IA(1, 1, (i + 1)));
+    devices[i].knx->setClock(bus.getPort(i));
+    devices[i].index = i;
+    devices[i].recalled = false;
+    devices[i].knx->setQueuedSend(true);
+    if (i == 0) {
+      for (uint8_t j = 1; j < SCENE_DEVICES; j++) {
+        devices[i].knx->addListenGroupAddress(KNX_GA(2, 0, j));
+      }
+    } else {
+      devices[i].knx->addListenGroupAddress(SCENE_GA);
+    }
+    bus.setPoll(i, pollSceneDevice, &devices[i], 5000);
+    sceneStatusCount[i] = 0;
+  }
+  sceneTraceHash = 2166136261UL;
+  bus.setMonitor(hashFrame, NULL);
+
+  bus.schedule(10000, 0, recallScene, &devices[0]);
+  bus.run(20000000ULL);
+
+  *stats = *bus.getStatistics();
+  uint8_t answered = 0;
+  for (uint8_t i = 1; i < SCENE_DEVICES; i++) {
+    answered += (sceneStatusCount[i] == 1) ? 1 : 0;
+  }
+  for (uint8_t i = 0; i < SCENE_DEVICES; i++) {
+    delete devices[i].knx;
+  }
+  return answered;
+}
+
+test(simulatorSceneRecallBurst) {
+  KnxBusSimulatorStatistics first;
+  KnxBusSimulatorStatistics second;
+  assertEquals(SCENE_DEVICES - 1, runSceneRecall(&first));
+  uint32_t firstHash = sceneTraceHash;
+  assertEquals(SCENE_DEVICES - 1, runSceneRecall(&second));
+
+  // the burst collides on the bus, but every telegram is sent once: the recall and one status
+  // per actuator, no repetition and no retransmission of the library
+  assertTrue(first.collisions > 0);
+  assertEquals((uint32_t)SCENE_DEVICES, first.frames);
+  assertEquals(0UL, (unsigned long)first.repetitions);
+  assertEquals((uint32_t)SCENE_DEVICES, first.acknowledged);
+  // and the same setup gives exactly the same traffic
+  assertEquals(firstHash, sceneTraceHash);
+  assertEquals(first.frames, second.frames);
+  assertEquals(first.busyMicros, second.busyMicros);
+}
+
+void setup() {
+}
+
+void loop() {
+  suite.run();
+}
@@ -0,0 +1,653 @@
+// File: KnxBusSimulator.cpp
+// Host only: a simulated KNX TP1 line for running several KnxTpUart instances against each other.
+
+#include "KnxBusSimulator.h"
+
+// KnxSimulatedTpUart
+
+KnxSimulatedTpUart::KnxSimulatedTpUart(KnxBusSimulator* aBus, uint8_t aIndex)
+{
+    mBus   = aBus;
+    mIndex = aIndex;
+
+    mRxHead         = 0;
+    mRxCount        = 0;
+    mToHostFreeAt   = 0;
+    mFromHostFreeAt = 0;
+
+    mDataFollows = false;
+    mDataEnd     = false;
+    mDataIndex   = 0;
+
+    mAckInfo     = 0;
+    mAckOwed     = false;
+    mLateAckOwed = false;
+
+    mPoll         = NULL;
+    mPollContext  = NULL;
+    mPollInterval = 0;
+    mPollPending  = false;
+    mActive       = false;
+
+    mConfirmed = 0;
+    mFailed    = 0;
+    mOverruns  = 0;
+}
+
+int KnxSimulatedTpUart::available()
+{
+    return mRxCount;
+}
+
+int KnxSimulatedTpUart::read()
+{
+    if (mRxCount == 0)
+    {
+        return -1;
+    }
+    uint8_t value = mRxBuffer[mRxHead];
+    mRxHead = (mRxHead + 1) % KNX_SIM_RX_BUFFER_SIZE;
+    mRxCount--;
+    return value;
+}
+
+int KnxSimulatedTpUart::peek()
+{
+    return (mRxCount == 0) ? -1 : mRxBuffer[mRxHead];
+}
+
+void KnxSimulatedTpUart::flush()
+{
+    uint64_t now = mBus->getTime();
+    if (mFromHostFreeAt > now)
+    {
+        mBus->sleepMicros(mFromHostFreeAt - now);
+    }
+}
+
+size_t KnxSimulatedTpUart::write(uint8_t aByte)
+{
+    mBus->sendToTpUart(this, aByte);
+    return 1;
+}
+
+uint8_t KnxSimulatedTpUart::getIndex()
+{
+    return mIndex;
+}
+
+uint32_t KnxSimulatedTpUart::getConfirmedCount()
+{
+    return mConfirmed;
+}
+
+uint32_t KnxSimulatedTpUart::getFailedCount()
+{
+    return mFailed;
+}
+
+uint32_t KnxSimulatedTpUart::getOverrunCount()
+{
+    return mOverruns;
+}
+
+unsigned long KnxSimulatedTpUart::getMicros()
+{
+    return (unsigned long)mBus->getMicros();
+}
+
+unsigned long KnxSimulatedTpUart::getMillis()
+{
+    return (unsigned long)(mBus->getMicros() / 1000);
+}
+
+void KnxSimulatedTpUart::wait(unsigned long aMaxUs)
+{
+    // the time has to advance even for a wait of 0, a host polling in a loop would hang otherwise
+    uint64_t end = mBus->getTime() + (aMaxUs > 0 ? aMaxUs : 1);
+    while (mRxCount == 0 && mBus->runNext(end))
+    {
+    }
+    if (mRxCount == 0 && end > mBus->mNow)
+    {
+        mBus->mNow = end;
+    }
+}
+
+// KnxBusSimulator
+
+KnxBusSimulator::KnxBusSimulator(uint8_t aDeviceCount, unsigned long aHostBaudrate)
+{
+    for (uint8_t i = 0; i < aDeviceCount; i++)
+    {
+        mPorts.push_back(new KnxSimulatedTpUart(this, i));
+    }
+    mSequence = 0;
+    mNow      = 0;
+
+    mHostByteTime  = (KNX_SIM_HOST_BYTE_BITS * 1000000ULL + aHostBaudrate / 2) / aHostBaudrate;
+    mPollLatency   = KNX_SIM_POLL_LATENCY_US;
+    mClockReadCost = KNX_SIM_CLOCK_READ_US;
+
+    mBusBusy      = false;
+    mStartPending = false;
+    mBusFreeAt    = 0;
+    mFrameStart   = 0;
+    mSender       = 0;
+
+    mAckLossRate = 0;
+    mRandom      = 1;
+
+    mMonitor        = NULL;
+    mMonitorContext = NULL;
+
+    memset(&mStatistics, 0, sizeof(mStatistics));
+
+    hostSetClock(this);
+}
+
+KnxBusSimulator::~KnxBusSimulator()
+{
+    hostSetClock(NULL);
+    for (uint8_t i = 0; i < mPorts.size(); i++)
+    {
+        delete mPorts[i];
+    }
+}
+
+uint8_t KnxBusSimulator::getDeviceCount()
+{
+    return mPorts.size();
+}
+
+KnxSimulatedTpUart* KnxBusSimulator::getPort(uint8_t aDevice)
+{
+    return mPorts[aDevice];
+}
+
+void KnxBusSimulator::setPoll(uint8_t aDevice, KnxSimulatorActionType aPoll, void* aContext, unsigned long aIntervalUs)
+{
+    KnxSimulatedTpUart* port = mPorts[aDevice];
+    bool periodic = (port->mPollInterval != 0);
+    port->mPoll         = aPoll;
+    port->mPollContext  = aContext;
+    port->mPollInterval = aIntervalUs;
+    if (aIntervalUs != 0 && !periodic)
+    {
+        post(mNow + aIntervalUs, EVENT_POLL_PERIODIC, aDevice);
+    }
+}
+
+void KnxBusSimulator::schedule(uint64_t aTime, uint8_t aDevice, KnxSimulatorActionType aAction, void* aContext)
+{
+    post(aTime > mNow ? aTime : mNow, EVENT_ACTION, aDevice, 0, aAction, aContext);
+}
+
+void KnxBusSimulator::setMonitor(KnxSimulatorMonitorType aMonitor, void* aContext)
+{
+    mMonitor        = aMonitor;
+    mMonitorContext = aContext;
+}
+
+void KnxBusSimulator::setPollLatency(unsigned long aUs)
+{
+    mPollLatency = aUs;
+}
+
+void KnxBusSimulator::setClockReadCost(unsigned long aUs)
+{
+    mClockReadCost = aUs;
+}
+
+void KnxBusSimulator::setAckLossRate(uint8_t aPercent, uint32_t aSeed)
+{
+    mAckLossRate = aPercent;
+    mRandom      = (aSeed != 0) ? aSeed : 1;
+}
+
+void KnxBusSimulator::injectReceived(uint8_t aDevice, const uint8_t* aData, uint8_t aLength)
+{
+    for (uint8_t i = 0; i < aLength; i++)
+    {
+        sendToHost(mPorts[aDevice], aData[i], mNow + getBitTime(KNX_SIM_CHAR_BITS * (i + 1)));
+    }
+}
+
+uint64_t KnxBusSimulator::getHostByteTime()
+{
+    return mHostByteTime;
+}
+
+void KnxBusSimulator::run(uint64_t aDurationUs)
+{
+    runUntil(mNow + aDurationUs);
+}
+
+void KnxBusSimulator::runUntil(uint64_t aTime)
+{
+    // also entered from hosts reading the clock or waiting, so an event may run while another one is running
+    while (runNext(aTime))
+    {
+    }
+    if (aTime > mNow)
+    {
+        mNow = aTime;
+    }
+}
+
+bool KnxBusSimulator::runNext(uint64_t aTime)
+{
+    if (mEvents.empty() || mEvents.top().time > aTime)
+    {
+        return false;
+    }
+    Event event = mEvents.top();
+    mEvents.pop();
+    if (event.time > mNow)
+    {
+        mNow = event.time;
+    }
+    process(event);
+    return true;
+}
+
+uint64_t KnxBusSimulator::getTime()
+{
+    return mNow;
+}
+
+uint64_t KnxBusSimulator::getBitTime(uint32_t aBits)
+{
+    return ((uint64_t)aBits * 1000000ULL + KNX_BUS_BAUDRATE / 2) / KNX_BUS_BAUDRATE;
+}
+
+const KnxBusSimulatorStatistics* KnxBusSimulator::getStatistics()
+{
+    return &mStatistics;
+}
+
+uint64_t KnxBusSimulator::getMicros()
+{
+    mNow += mClockReadCost;
+    runUntil(mNow);
+    return mNow;
+}
+
+void KnxBusSimulator::sleepMicros(uint64_t aMicros)
+{
+    runUntil(mNow + aMicros);
+}
+
+void KnxBusSimulator::post(uint64_t aTime, EventType aType, uint8_t aDevice, uint8_t aData,
+                           KnxSimulatorActionType aAction, void* aContext)
+{
+    Event event;
+    event.time     = aTime;
+    event.sequence = mSequence++;
+    event.type     = aType;
+    event.device   = aDevice;
+    event.data     = aData;
+    event.action   = aAction;
+    event.context  = aContext;
+    mEvents.push(event);
+}
+
+void KnxBusSimulator::process(const Event& aEvent)
+{
+    KnxSimulatedTpUart* port = mPorts[aEvent.device];
+    switch (aEvent.type)
+    {
+        case EVENT_TO_TPUART:
+            receiveFromHost(port, aEvent.data);
+            break;
+
+        case EVENT_TO_HOST:
+            receiveOnHost(port, aEvent.data);
+            break;
+
+        case EVENT_BUS_START:
+            startFrame();
+            break;
+
+        case EVENT_BUS_ACK:
+            endFrame();
+            break;
+
+        case EVENT_POLL:
+            port->mPollPending = false;
+            if (!port->mActive)
+            {
+                // an active host is polled again when it returns, see runHost()
+                runHost(port, port->mPoll, port->mPollContext);
+            }
+            break;
+
+        case EVENT_POLL_PERIODIC:
+            if (port->mPollInterval == 0)
+            {
+                break;
+            }
+            if (!port->mActive)
+            {
+                runHost(port, port->mPoll, port->mPollContext);
+            }
+            post((aEvent.time + port->mPollInterval > mNow) ? aEvent.time + port->mPollInterval : mNow,
+                 EVENT_POLL_PERIODIC, aEvent.device);
+            break;
+
+        case EVENT_ACTION:
+            if (port->mActive)
+            {
+                post(mNow + mPollLatency, EVENT_ACTION, aEvent.device, 0, aEvent.action, aEvent.context);
+            }
+            else
+            {
+                runHost(port, aEvent.action, aEvent.context);
+            }
+            break;
+    }
+}
+
+void KnxBusSimulator::runHost(KnxSimulatedTpUart* aPort, KnxSimulatorActionType aAction, void* aContext)
+{
+    if (aAction == NULL)
+    {
+        return;
+    }
+    aPort->mActive = true;
+    aAction(aContext);
+    aPort->mActive = false;
+
+    if (aPort->mRxCount > 0)
+    {
+        schedulePoll(aPort);
+    }
+}
+
+void KnxBusSimulator::schedulePoll(KnxSimulatedTpUart* aPort)
+{
+    if (aPort->mPoll != NULL && !aPort->mPollPending)
+    {
+        aPort->mPollPending = true;
+        post(mNow + mPollLatency, EVENT_POLL, aPort->mIndex);
+    }
+}
+
+// Host link
+
+void KnxBusSimulator::sendToTpUart(KnxSimulatedTpUart* aPort, uint8_t aByte)
+{
+    uint64_t start = (aPort->mFromHostFreeAt > mNow) ? aPort->mFromHostFreeAt : mNow;
+    aPort->mFromHostFreeAt = start + mHostByteTime;
+    post(aPort->mFromHostFreeAt, EVENT_TO_TPUART, aPort->mIndex, aByte);
+}
+
+void KnxBusSimulator::sendToHost(KnxSimulatedTpUart* aPort, uint8_t aByte, uint64_t aTime)
+{
+    uint64_t start = (aPort->mToHostFreeAt > aTime) ? aPort->mToHostFreeAt : aTime;
+    aPort->mToHostFreeAt = start + mHostByteTime;
+    post(aPort->mToHostFreeAt, EVENT_TO_HOST, aPort->mIndex, aByte);
+}
+
+void KnxBusSimulator::receiveOnHost(KnxSimulatedTpUart* aPort, uint8_t aByte)
+{
+    if (aPort->mRxCount == KNX_SIM_RX_BUFFER_SIZE)
+    {
+        aPort->mOverruns++;
+    }
+    else
+    {
+        aPort->mRxBuffer[(aPort->mRxHead + aPort->mRxCount) % KNX_SIM_RX_BUFFER_SIZE] = aByte;
+        aPort->mRxCount++;
+    }
+    schedulePoll(aPort);
+}
+
+void KnxBusSimulator::receiveFromHost(KnxSimulatedTpUart* aPort, uint8_t aByte)
+{
+    if (aPort->mDataFollows)
+    {
+        // the telegram byte after a data service
+        aPort->mDataFollows = false;
+        if (aPort->mDataIndex < MAX_KNX_TELEGRAM_SIZE)
+        {
+            aPort->mAssembly.data[aPort->mDataIndex] = aByte;
+            if (aPort->mDataEnd)
+            {
+                aPort->mAssembly.length  = aPort->mDataIndex + 1;
+                aPort->mAssembly.repeats   = 0;
+                aPort->mAssembly.discarded = false;
+                aPort->mTxFrames.push_back(aPort->mAssembly);
+                requestBus();
+            }
+        }
+        return;
+    }
+
+    uint8_t service = aByte & B11000000;
+    if (service == TPUART_DATA_START_CONTINUE || service == TPUART_DATA_END)
+    {
+        aPort->mDataFollows = true;
+        aPort->mDataEnd     = (service == TPUART_DATA_END);
+        aPort->mDataIndex   = aByte & B00111111;
+    }
+    else if ((aByte & KNX_SIM_ACK_INFO_MASK) == KNX_SIM_ACK_INFO)
+    {
+        receiveAckInfo(aPort, aByte);
+    }
+    else if (aByte == TPUART_RESET)
+    {
+        // drop everything not yet on the bus, the frame on the bus is finished but forgotten
+        bool sending = mBusBusy && mSender == aPort->mIndex;
+        while (aPort->mTxFrames.size() > (sending ? 1U : 0U))
+        {
+            aPort->mTxFrames.pop_back();
+        }
+        if (sending)
+        {
+            aPort->mTxFrames.front().discarded = true;
+        }
+        sendToHost(aPort, TPUART_RESET_INDICATION_BYTE, mNow);
+    }
+    else if (aByte == TPUART_STATE_REQUEST)
+    {
+        sendToHost(aPort, KNX_SIM_STATE_INDICATION, mNow);
+    }
+}
+
+void KnxBusSimulator::receiveAckInfo(KnxSimulatedTpUart* aPort, uint8_t aByte)
+{
+    // the hosts answer the frames in order, the first answer after a missed slot belongs to the missed frame
+    if (aPort->mLateAckOwed)
+    {
+        aPort->mLateAckOwed = false;
+        mStatistics.lateAcks++;
+    }
+    else if (aPort->mAckOwed)
+    {
+        aPort->mAckOwed = false;
+        aPort->mAckInfo = aByte;
+    }
+}
+
+// Bus
+
+void KnxBusSimulator::requestBus()
+{
+    if (!mBusBusy && !mStartPending)
+    {
+        mStartPending = true;
+        post((mBusFreeAt > mNow) ? mBusFreeAt : mNow, EVENT_BUS_START, 0);
+    }
+}
+
+bool KnxBusSimulator::winsArbitration(const uint8_t* aFrame, const uint8_t* aOther, uint8_t aLength)
+{
+    // bits are sent LSB first, a 0 bit overwrites a 1 bit on the line
+    for (uint8_t i = 0; i < aLength; i++)
+    {
+        uint8_t diff = aFrame[i] ^ aOther[i];
+        if (diff != 0)
+        {
+            return (aFrame[i] & (diff & -diff)) == 0;
+        }
+    }
+    return false;
+}
+
+void KnxBusSimulator::startFrame()
+{
+    mStartPending = false;
+
+    KnxSimulatedTpUart* sender = NULL;
+    uint8_t contenders = 0;
+    for (uint8_t i = 0; i < mPorts.size(); i++)
+    {
+        if (mPorts[i]->mTxFrames.empty())
+        {
+            continue;
+        }
+        contenders++;
+        const KnxSimulatedTpUart::Frame& frame = mPorts[i]->mTxFrames.front();
+        if (sender == NULL)
+        {
+            sender = mPorts[i];
+        }
+        else
+        {
+            const KnxSimulatedTpUart::Frame& best = sender->mTxFrames.front();
+            uint8_t length = (frame.length < best.length) ? frame.length : best.length;
+            if (winsArbitration(frame.data, best.data, length))
+            {
+                sender = mPorts[i];
+            }
+        }
+    }
+    if (sender == NULL)
+    {
+        return;
+    }
+    mStatistics.collisions += contenders - 1;
+
+    const KnxSimulatedTpUart::Frame& frame = sender->mTxFrames.front();
+    mBusBusy    = true;
+    mSender     = sender->mIndex;
+    mFrameStart = mNow;
+    mStatistics.frames++;
+    if (frame.repeats > 0)
+    {
+        mStatistics.repetitions++;
+    }
+
+    // every other TP-UART passes the characters to its host as they come in
+    for (uint8_t i = 0; i < mPorts.size(); i++)
+    {
+        KnxSimulatedTpUart* port = mPorts[i];
+        if (port == sender)
+        {
+            continue;
+        }
+        port->mAckOwed = true;
+        port->mAckInfo = 0;
+        for (uint8_t j = 0; j < frame.length; j++)
+        {
+            sendToHost(port, frame.data[j], mFrameStart + getBitTime(KNX_SIM_CHAR_BITS * (j + 1)));
+        }
+    }
+
+    post(mFrameStart + getBitTime(KNX_SIM_CHAR_BITS * frame.length + KNX_SIM_ACK_GAP_BITS), EVENT_BUS_ACK, mSender);
+}
+
+void KnxBusSimulator::endFrame()
+{
+    KnxSimulatedTpUart* sender = mPorts[mSender];
+    KnxSimulatedTpUart::Frame& frame = sender->mTxFrames.front();
+
+    // the acknowledge characters of all receivers overlap, NACK wins over BUSY wins over ACK
+    bool ack  = false;
+    bool busy = false;
+    bool nack = false;
+    for (uint8_t i = 0; i < mPorts.size(); i++)
+    {
+        KnxSimulatedTpUart* port = mPorts[i];
+        if (port == sender)
+        {
+            continue;
+        }
+        if (port->mAckOwed)
+        {
+            port->mAckOwed     = false;
+            port->mLateAckOwed = true;
+            continue;
+        }
+        nack |= (port->mAckInfo & B00000100) != 0;
+        busy |= (port->mAckInfo & B00000010) != 0;
+        ack  |= (port->mAckInfo & B00000001) != 0;
+    }
+    bool acknowledged = ack && !busy && !nack;
+    if (acknowledged && mAckLossRate > 0 && nextRandomPercent(mAckLossRate))
+    {
+        acknowledged = false;
+        mStatistics.lostAcks++;
+    }
+
+    uint64_t end = mNow + getBitTime(KNX_SIM_ACK_BITS);
+    mStatistics.busyMicros += end - mFrameStart;
+
+    if (mMonitor != NULL)
+    {
+        mMonitor(frame.data, frame.length, mSender, acknowledged, mMonitorContext);
+    }
+
+    if (frame.discarded)
+    {
+        if (acknowledged)
+        {
+            mStatistics.acknowledged++;
+        }
+        sender->mTxFrames.pop_front();
+    }
+    else if (acknowledged)
+    {
+        mStatistics.acknowledged++;
+        sender->mConfirmed++;
+        sender->mTxFrames.pop_front();
+        sendToHost(sender, TPUART_SEND_SUCCESS, end);
+    }
+    else if (frame.repeats < KNX_SIM_MAX_REPEATS)
+    {
+        // repeat with the repeat flag set (bit cleared), the checksum covers the same bit
+        frame.repeats++;
+        if ((frame.data[0] & B00100000) != 0)
+        {
+            frame.data[0]                ^= B00100000;
+            frame.data[frame.length - 1] ^= B00100000;
+        }
+    }
+    else
+    {
+        sender->mFailed++;
+        sender->mTxFrames.pop_front();
+        sendToHost(sender, TPUART_SEND_NOT_SUCCESS, end);
+    }
+
+    mBusBusy   = false;
+    mBusFreeAt = end + getBitTime(KNX_SIM_IDLE_BITS);
+    for (uint8_t i = 0; i < mPorts.size(); i++)
+    {
+        if (!mPorts[i]->mTxFrames.empty())
+        {
+            requestBus();
+            break;
+        }
+    }
+}
+
+bool KnxBusSimulator::nextRandomPercent(uint8_t aPercent)
+{
+    // xorshift32, deterministic for a given seed
+    mRandom ^= mRandom << 13;
+    mRandom ^= mRandom >> 17;
+    mRandom ^= mRandom << 5;
+    return (mRandom % 100) < aPercent;
+}
@@ -0,0 +1,377 @@
+// File: KnxBusSimulator.h
+// Host only: a simulated KNX TP1 line for running several KnxTpUart instances against each other.
+// Every device gets a simulated TP-UART as Stream, all of them share one bus driven by a virtual clock.
+
+#ifndef KnxBusSimulator_h
+#define KnxBusSimulator_h
+
+#include "Arduino.h"
+#include "KnxTpUart.h"
+
+#include <deque>
+#include <queue>
+#include <vector>
+
+// Bits per character on the bus: start, 8 data, parity, stop and 2 bit pause
+#define KNX_SIM_CHAR_BITS 13
+
+// Bits between the end of a frame and the acknowledge character
+#define KNX_SIM_ACK_GAP_BITS 15
+
+// Bits of the acknowledge character
+#define KNX_SIM_ACK_BITS 11
+
+// Bits the bus has to be idle before a frame may start
+#define KNX_SIM_IDLE_BITS 50
+
+// Number of repetitions of a frame that is not acknowledged, done by the TP-UART itself
+#define KNX_SIM_MAX_REPEATS 3
+
+// Bits per byte on the link between host and TP-UART (8E1)
+#define KNX_SIM_HOST_BYTE_BITS 11
+
+// Size of the receive buffer of the host UART, bytes arriving when it is full are lost (like HardwareSerial)
+#define KNX_SIM_RX_BUFFER_SIZE 64
+
+// Acknowledge information from the host: bit 0 addressed, bit 1 busy, bit 2 NACK
+#define KNX_SIM_ACK_INFO_MASK B11111000
+#define KNX_SIM_ACK_INFO      B00010000
+
+// Answer of the TP-UART to TPUART_STATE_REQUEST, no error flags set
+#define KNX_SIM_STATE_INDICATION B00000111
+
+// Default time in us between bytes arriving at a host and the host looking at them, see KnxBusSimulator::setPollLatency()
+#define KNX_SIM_POLL_LATENCY_US 50
+
+// Default time in us every clock read takes, see KnxBusSimulator::setClockReadCost()
+#define KNX_SIM_CLOCK_READ_US 1
+
+class KnxBusSimulator;
+
+/**
+ * Function run by the simulator for a device, e.g. its loop calling KnxTpUart::serialEvent().
+ */
+typedef void (*KnxSimulatorActionType)(void* aContext);
+
+/**
+ * Called after the acknowledge slot of every frame on the bus, like a bus monitor.
+ * @param aFrame the telegram as sent on the bus including the checksum.
+ * @param aSender the index of the sending device.
+ * @param aAcknowledged true if at least one receiver acknowledged the frame.
+ */
+typedef void (*KnxSimulatorMonitorType)(const uint8_t* aFrame, uint8_t aLength, uint8_t aSender,
+                                        bool aAcknowledged, void* aContext);
+
+/**
+ * Statistics of the simulated bus, see KnxBusSimulator::getStatistics().
+ */
+struct KnxBusSimulatorStatistics
+{
+  uint32_t frames;        // frames sent on the bus including repetitions
+  uint32_t repetitions;   // frames sent again by the TP-UART because no acknowledge was received
+  uint32_t collisions;    // transmissions delayed because another device won the arbitration
+  uint32_t acknowledged;  // frames acknowledged by at least one receiver
+  uint32_t lostAcks;      // acknowledges dropped by the fault injection, see KnxBusSimulator::setAckLossRate()
+  uint32_t lateAcks;      // acknowledge information of a host that arrived after the acknowledge slot
+  uint64_t busyMicros;    // time the bus was occupied by frames and acknowledge slots
+};
+
+/**
+ * The TP-UART of one device as seen by its host, given as Stream to KnxTpUart.
+ * Written bytes reach the TP-UART after their time on the host link, received bytes are
+ * buffered like in a HardwareSerial until the host reads them.
+ * Supported services from the host: data start/continue/end, acknowledge information,
+ * TPUART_RESET (answered by TPUART_RESET_INDICATION_BYTE, telegrams given before are discarded) and TPUART_STATE_REQUEST.
+ * Telegrams sent are confirmed by TPUART_SEND_SUCCESS or TPUART_SEND_NOT_SUCCESS.
+ * It is the clock of its device as well, see KnxTpUart::setClock(): a wait of the library lets the
+ * simulation run until bytes arrive for the device, like a host sleeping until its UART interrupt.
+ */
+class KnxSimulatedTpUart : public Stream, public KnxClock
+{
+  public:
+    int available();
+    int read();
+    int peek();
+
+    /**
+     * Wait until all written bytes reached the TP-UART.
+     */
+    void flush();
+
+    size_t write(uint8_t aByte);
+    using Print::write;
+
+    /**
+     * @return the index of the device within the simulator.
+     */
+    uint8_t getIndex();
+
+    /**
+     * @return the number of telegrams confirmed to the host with TPUART_SEND_SUCCESS.
+     */
+    uint32_t getConfirmedCount();
+
+    /**
+     * @return the number of telegrams given up after all repetitions (TPUART_SEND_NOT_SUCCESS).
+     */
+    uint32_t getFailedCount();
+
+    /**
+     * @return the number of bytes lost because the host did not read its receive buffer in time.
+     */
+    uint32_t getOverrunCount();
+
+    /**
+     * @return the simulated time, reading it takes the clock read cost like micros().
+     */
+    unsigned long getMicros();
+
+    unsigned long getMillis();
+
+    /**
+     * Run the simulation until bytes arrived for this device or aMaxUs elapsed, at least 1 us.
+     */
+    void wait(unsigned long aMaxUs);
+
+  private:
+    friend class KnxBusSimulator;
+
+    struct Frame
+    {
+        uint8_t data[MAX_KNX_TELEGRAM_SIZE];
+        uint8_t length;
+        uint8_t repeats;
+        bool discarded;  // reset while on the bus: it ends, but is neither repeated nor confirmed
+    };
+
+    KnxSimulatedTpUart(KnxBusSimulator* aBus, uint8_t aIndex);
+
+    KnxBusSimulator* mBus;
+    uint8_t mIndex;
+
+    // host side: receive buffer and the time the link in either direction is busy until
+    uint8_t mRxBuffer[KNX_SIM_RX_BUFFER_SIZE];
+    uint8_t mRxHead;
+    uint8_t mRxCount;
+    uint64_t mToHostFreeAt;
+    uint64_t mFromHostFreeAt;
+
+    // telegram assembled from the data services of the host
+    Frame mAssembly;
+    bool mDataFollows;
+    bool mDataEnd;
+    uint8_t mDataIndex;
+
+    // telegrams waiting for the bus, the first one is sent next
+    std::deque<Frame> mTxFrames;
+
+    // acknowledge information of the host for the frame on the bus
+    uint8_t mAckInfo;
+    bool mAckOwed;
+    bool mLateAckOwed;
+
+    // the simulated host
+    KnxSimulatorActionType mPoll;
+    void* mPollContext;
+    unsigned long mPollInterval;
+    bool mPollPending;
+    bool mActive;
+
+    uint32_t mConfirmed;
+    uint32_t mFailed;
+    uint32_t mOverruns;
+};
+
+/**
+ * A KNX TP1 line at KNX_BUS_BAUDRATE with a TP-UART per device.
+ * The bus is modelled character by character: frames start after the bus was idle for
+ * KNX_SIM_IDLE_BITS, devices starting at the same time are arbitrated bit by bit (a 0 bit wins,
+ * so priority, repeat flag and source address decide like on a real line), the acknowledge of
+ * the receivers follows the frame and a frame nobody acknowledged is repeated by its TP-UART.
+ *
+ * All of this runs on a virtual clock: while a simulator exists millis(), micros() and delay()
+ * return and advance the simulated time, so an idle hour takes no real time at all.
+ * The hosts are run through actions: a poll action per device is run when bytes arrive for it
+ * (after the poll latency) and optionally periodically, further actions can be scheduled.
+ * A host blocking in delay() lets the simulation continue, its own actions are postponed
+ * until it returns. Everything is deterministic, the same setup gives the same bus traffic.
+ * Given to KnxTpUart::setClock() the port is the clock of the library too, so it waits for
+ * bytes exactly as long as it takes them to arrive.
+ * <pre>
+ * KnxBusSimulator bus(2);
+ * KnxTpUart sender(bus.getPort(0), KNX_IA(1,1,1));
+ * KnxTpUart receiver(bus.getPort(1), KNX_IA(1,1,2));
+ * sender.setClock(bus.getPort(0));
+ * bus.setPoll(1, pollReceiver, &receiver);
+ * bus.schedule(1000, 0, sendSomething, &sender);
+ * bus.run(1000000);
+ * </pre>
+ */
+class KnxBusSimulator : public HostClock
+{
+  public:
+    /**
+     * Create the bus with the given number of devices (max 255) and install its clock.
+     * @param aHostBaudrate the baud rate of the link between host and TP-UART.
+     */
+    KnxBusSimulator(uint8_t aDeviceCount, unsigned long aHostBaudrate = 19200);
+
+    /**
+     * Restores the system clock.
+     */
+    ~KnxBusSimulator();
+
+    uint8_t getDeviceCount();
+
+    /**
+     * @return the TP-UART of the given device.
+     */
+    KnxSimulatedTpUart* getPort(uint8_t aDevice);
+
+    /**
+     * Set the loop of a device. It is run whenever bytes arrived for the device and, if aIntervalUs
+     * is not 0, periodically (needed to service the send queue or timeouts without traffic).
+     */
+    void setPoll(uint8_t aDevice, KnxSimulatorActionType aPoll, void* aContext, unsigned long aIntervalUs = 0);
+
+    /**
+     * Run an action for a device at the given simulated time, e.g. a push button sending a telegram.
+     */
+    void schedule(uint64_t aTime, uint8_t aDevice, KnxSimulatorActionType aAction, void* aContext);
+
+    /**
+     * Observe all frames on the bus, NULL to stop.
+     */
+    void setMonitor(KnxSimulatorMonitorType aMonitor, void* aContext);
+
+    /**
+     * Time between a byte arriving at a host and its poll action, the reaction time of the main loop.
+     */
+    void setPollLatency(unsigned long aUs);
+
+    /**
+     * Time every read of millis() or micros() takes. This lets hosts polling the clock without
+     * delay() make progress, 0 stops the time while a host is running.
+     */
+    void setClockReadCost(unsigned long aUs);
+
+    /**
+     * Drop the given share of acknowledges, so frames get repeated like on a noisy line.
+     * @param aSeed the start value of the pseudo random sequence deciding which ones.
+     */
+    void setAckLossRate(uint8_t aPercent, uint32_t aSeed = 1);
+
+    /**
+     * Pass bytes to the host of a device as its TP-UART receives them from the bus, one character
+     * time apart starting now, without a frame on the bus. E.g. the start of a telegram to play a
+     * frame cut off by a disturbance.
+     */
+    void injectReceived(uint8_t aDevice, const uint8_t* aData, uint8_t aLength);
+
+    /**
+     * @return the time in us a byte takes on the link between host and TP-UART.
+     */
+    uint64_t getHostByteTime();
+
+    /**
+     * Advance the simulation by the given time.
+     */
+    void run(uint64_t aDurationUs);
+
+    /**
+     * Advance the simulation up to the given time.
+     */
+    void runUntil(uint64_t aTime);
+
+    /**
+     * @return the simulated time in microseconds.
+     */
+    uint64_t getTime();
+
+    /**
+     * @return the duration of the given number of bits on the bus in microseconds.
+     */
+    static uint64_t getBitTime(uint32_t aBits);
+
+    const KnxBusSimulatorStatistics* getStatistics();
+
+    uint64_t getMicros();
+
+    void sleepMicros(uint64_t aMicros);
+
+  private:
+    friend class KnxSimulatedTpUart;
+
+    enum EventType
+    {
+      EVENT_TO_TPUART,    // a byte from the host reaches the TP-UART
+      EVENT_TO_HOST,      // a byte from the TP-UART reaches the host
+      EVENT_BUS_START,    // the bus is free, the pending frames are arbitrated
+      EVENT_BUS_ACK,      // acknowledge slot of the frame on the bus
+      EVENT_POLL,         // the host reacts to received bytes
+      EVENT_POLL_PERIODIC,
+      EVENT_ACTION
+    };
+
+    struct Event
+    {
+        uint64_t time;
+        uint32_t sequence;
+        uint8_t type;
+        uint8_t device;
+        uint8_t data;
+        KnxSimulatorActionType action;
+        void* context;
+
+        bool operator>(const Event& aOther) const
+        {
+            return time != aOther.time ? time > aOther.time : sequence > aOther.sequence;
+        }
+    };
+
+    void post(uint64_t aTime, EventType aType, uint8_t aDevice, uint8_t aData = 0,
+              KnxSimulatorActionType aAction = NULL, void* aContext = NULL);
+    void process(const Event& aEvent);
+
+    void sendToTpUart(KnxSimulatedTpUart* aPort, uint8_t aByte);
+    void sendToHost(KnxSimulatedTpUart* aPort, uint8_t aByte, uint64_t aTime);
+    void receiveFromHost(KnxSimulatedTpUart* aPort, uint8_t aByte);
+    void receiveAckInfo(KnxSimulatedTpUart* aPort, uint8_t aByte);
+    void receiveOnHost(KnxSimulatedTpUart* aPort, uint8_t aByte);
+
+    void requestBus();
+    void startFrame();
+    void endFrame();
+    static bool winsArbitration(const uint8_t* aFrame, const uint8_t* aOther, uint8_t aLength);
+
+    bool runNext(uint64_t aTime);
+    void runHost(KnxSimulatedTpUart* aPort, KnxSimulatorActionType aAction, void* aContext);
+    void schedulePoll(KnxSimulatedTpUart* aPort);
+    bool nextRandomPercent(uint8_t aPercent);
+
+    std::vector<KnxSimulatedTpUart*> mPorts;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > mEvents;
+    uint32_t mSequence;
+    uint64_t mNow;
+
+    uint64_t mHostByteTime;
+    unsigned long mPollLatency;
+    unsigned long mClockReadCost;
+
+    // bus state
+    bool mBusBusy;
+    bool mStartPending;
+    uint64_t mBusFreeAt;
+    uint64_t mFrameStart;
+    uint8_t mSender;
+
+    uint8_t mAckLossRate;
+    uint32_t mRandom;
+
+    KnxSimulatorMonitorType mMonitor;
+    void* mMonitorContext;
+
+    KnxBusSimulatorStatistics mStatistics;
+};
+
+#endif
@@ -0,0 +1,110 @@
+// File: RingBufferStressTests.ino
+// Host only: KnxRingBuffer with the producer (the UART interrupt on a board) and the consumer on two threads.
+// Built and run by CMake, see README.md.
+
+#include <KnxRingBuffer.h>
+#include <ArduinoUnit.h>
+#include <thread>
+
+TestSuite suite;
+
+#define STRESS_BYTES 2000000UL
+
+// The producer pushes the low byte of the number of bytes it got into the ring so far,
+// so the consumer can check the sequence even if pushes are rejected.
+struct StressProducer {
+  KnxRingBuffer<64>* ring;
+  bool retry;
+  unsigned long sent;
+  unsigned long rejected;
+  bool done;
+};
+
+void produce(StressProducer* producer) {
+  // with retry STRESS_BYTES are sent, otherwise STRESS_BYTES are tried
+  while (producer->sent < STRESS_BYTES && (producer->retry || producer->sent + producer->rejected < STRESS_BYTES)) {
+    if (producer->ring->push((uint8_t)producer->sent)) {
+      producer->sent++;
+    } else {
+      // an interrupt cannot wait, the byte is lost, a retry lets the consumer run on a single core
+      producer->rejected++;
+      if (producer->retry) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  __atomic_store_n(&producer->done, true, __ATOMIC_RELEASE);
+}
+
+// Read until the producer is done and the ring is empty, alternating single and bulk reads.
+// @return the number of bytes read out of order, 0 if the sequence is complete.
+unsigned long consume(StressProducer* producer, unsigned long* aReceived) {
+  KnxRingBuffer<64>* ring = producer->ring;
+  uint8_t buf[24];
+  uint8_t expected = 0;
+  unsigned long errors = 0;
+  unsigned long received = 0;
+  while (!__atomic_load_n(&producer->done, __ATOMIC_ACQUIRE) || ring->available() > 0) {
+    if ((received & 1) == 0) {
+      int c = ring->read();
+      if (c < 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      errors += ((uint8_t)c != expected) ? 1 : 0;
+      expected = (uint8_t)c + 1;
+      received++;
+    } else {
+      uint8_t count = ring->read(buf, (uint8_t)(received % sizeof(buf)) + 1);
+      if (count == 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      for (uint8_t i = 0; i < count; i++) {
+        errors += (buf[i] != expected) ? 1 : 0;
+        expected = buf[i] + 1;
+      }
+      received += count;
+    }
+  }
+  *aReceived = received;
+  return errors;
+}
+
+unsigned long runStress(StressProducer* producer, unsigned long* aReceived) {
+  std::thread thread(produce, producer);
+  unsigned long errors = consume(producer, aReceived);
+  thread.join();
+  return errors;
+}
+
+test(ringBufferThreadedNoLoss) {
+  KnxRingBuffer<64> ring;
+  StressProducer producer = { &ring, true, 0, 0, false };
+  unsigned long received;
+
+  // the producer retries a full ring, every byte arrives exactly once and in order
+  assertEquals(0UL, runStress(&producer, &received));
+  assertEquals(STRESS_BYTES, received);
+  assertEquals(0, ring.available());
+  assertEquals(producer.rejected > 255 ? 255UL : producer.rejected, (unsigned long)ring.getOverrunCount());
+}
+
+test(ringBufferThreadedOverrun) {
+  KnxRingBuffer<64> ring;
+  StressProducer producer = { &ring, false, 0, 0, false };
+  unsigned long received;
+
+  // bytes pushed into a full ring are lost and counted, the others arrive in order
+  assertEquals(0UL, runStress(&producer, &received));
+  assertEquals(producer.sent, received);
+  assertEquals(STRESS_BYTES, received + producer.rejected);
+  assertEquals(producer.rejected > 255 ? 255UL : producer.rejected, (unsigned long)ring.getOverrunCount());
+}
+
+void setup() {
+}
+
+void loop() {
+  suite.run();
+}
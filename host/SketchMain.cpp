@@ -0,0 +1,22 @@
+// File: SketchMain.cpp
+// Entry point for running a sketch on a Linux host: setup() once, then loop().
+// If HOST_LOOP_COUNT is defined loop() runs that many times, otherwise forever.
+
+#include "Arduino.h"
+
+void setup();
+void loop();
+
+int main()
+{
+    setup();
+#ifdef HOST_LOOP_COUNT
+    for (unsigned long i = 0; i < HOST_LOOP_COUNT; i++)
+#else
+    for (;;)
+#endif
+    {
+        loop();
+    }
+    return 0;
+}